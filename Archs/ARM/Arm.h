@@ -52,6 +52,7 @@ public:
 
 	std::vector<ArmPoolEntry> getPoolContent() { return currentPoolContent; }
 	void clearPoolContent() { currentPoolContent.clear(); }
+	void setPoolContent(const std::vector<ArmPoolEntry>& content) { currentPoolContent = content; }
 	void addPoolValue(ArmOpcodeCommand* command, int32_t value);
 private:
 	bool thumb;
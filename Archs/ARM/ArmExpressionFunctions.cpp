@@ -9,13 +9,13 @@
 	if (getExpFuncParameter(params,index,dest,funcName,false) == false) \
 		return ExpressionValue();
 
-ExpressionValue expFuncIsArm(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncIsArm(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	bool isArm = Arch == &Arm && !Arm.GetThumbMode();
 	return ExpressionValue(isArm ? INT64_C(1) : INT64_C(0));
 }
 
-ExpressionValue expFuncIsThumb(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncIsThumb(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	bool isThumb = Arm.GetThumbMode();
 	return ExpressionValue(isThumb ? INT64_C(1) : INT64_C(0));
@@ -8,6 +8,10 @@
 
 #include <cstddef>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 const char ArmConditions[16][3] = {
 	"eq","ne","cs","cc","mi","pl","vs","vc","hi","ls","ge","lt","gt","le","","nv"
 };
@@ -22,6 +26,53 @@ const char ArmPsrModes[16][5] = {
 };
 */
 
+static int countTrailingZeros(uint32_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index,value);
+	return (int) index;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+static uint32_t rotateLeft(uint32_t value, int amount)
+{
+	return (value << amount) | (value >> (-amount & 31));
+}
+
+// uses the smallest possible rotation, like searching all 16 of them would
+ArmShiftedImmediate encodeArmShiftedImmediate(uint32_t value)
+{
+	if (value <= 0xFF)
+		return { true, (int) value, 0 };
+
+	// if the set bits don't wrap around, the lowest one has to end up in
+	// bit 0 or 1. otherwise the lowest bit above the first byte has to be
+	// rotated past bit 31
+	int shiftAmount = (32 - (countTrailingZeros(value) & ~1)) & 31;
+	uint32_t rotated = rotateLeft(value,shiftAmount);
+	if (rotated <= 0xFF)
+		return { true, (int) rotated, shiftAmount };
+
+	shiftAmount = (33 - countTrailingZeros(value & 0xFFFFFF00)) & ~1;
+	rotated = rotateLeft(value,shiftAmount);
+	if (rotated <= 0xFF)
+		return { true, (int) rotated, shiftAmount };
+
+	return { false, 0, 0 };
+}
+
+ArmImmediateEncodings encodeArmImmediate(uint32_t value)
+{
+	ArmImmediateEncodings result;
+	result.direct = encodeArmShiftedImmediate(value);
+	result.inverted = encodeArmShiftedImmediate(~value);
+	result.negated = encodeArmShiftedImmediate(0-value);
+	return result;
+}
+
 bool CArmInstruction::Load(char *Name, char *Params)
 {
 	return false;
@@ -34,21 +85,6 @@ CArmInstruction::CArmInstruction(const tArmOpcode& sourceOpcode, ArmOpcodeVariab
 	arch = Arm.getVersion();
 }
 
-int CArmInstruction::getShiftedImmediate(unsigned int num, int& ShiftAmount)
-{
-	for (int i = 0; i < 32; i+=2)
-	{
-		unsigned int andval = (0xFFFFFF00 >> i) | (0xFFFFFF00 << (-i & 31));
-
-		if ((num & andval) == 0)	// found it
-		{
-			ShiftAmount = i;
-			return (num << i) | (num >> (-i & 31));
-		}
-	}
-	return -1;
-}
-
 void CArmInstruction::setPoolAddress(int64_t address)
 {
 	int pos = (int) (address-((RamPos+8) & 0xFFFFFFFD));
@@ -197,7 +233,6 @@ bool CArmInstruction::Validate(const ValidateState &state)
 
 		if (Opcode.flags & ARM_SHIFT)	// shifted immediate, eg 4000h
 		{
-			int temp;
 			Vars.negative = false;
 			if ((Opcode.flags & ARM_ABS) && Vars.Immediate < 0)
 			{
@@ -216,41 +251,56 @@ bool CArmInstruction::Validate(const ValidateState &state)
 				}
 			}
 
-			if ((temp = getShiftedImmediate(Vars.Immediate,Vars.Shift.ShiftAmount)) == -1)
+			ArmImmediateEncodings encodings = encodeArmImmediate(Vars.Immediate);
+			ArmShiftedImmediate immediate = encodings.direct;
+			if (!immediate.valid && (Opcode.flags & ARM_OPTIMIZE))
 			{
-				// mov/mvn -> mvn/mov
-				if ((Opcode.flags & ARM_OPTIMIZE) && (temp = getShiftedImmediate(~Vars.Immediate,Vars.Shift.ShiftAmount)) != -1)
+				// mov/mvn and and/bic use the inverted value, cmp/cmn and add/sub the negated one
+				if (Opcode.flags & (ARM_OPMOVMVN|ARM_OPANDBIC))
+					immediate = encodings.inverted;
+				else
+					immediate = encodings.negated;
+
+				if (immediate.valid)
 				{
 					if (Opcode.flags & ARM_OPMOVMVN) Vars.Opcode.NewEncoding = Opcode.encoding ^ 0x0400000;
 					if (Opcode.flags & ARM_OPANDBIC) Vars.Opcode.NewEncoding = Opcode.encoding ^ 0x1C00000;
 					if (Opcode.flags & ARM_OPCMPCMN) Vars.Opcode.NewEncoding = Opcode.encoding ^ 0x0200000;
+					if (Opcode.flags & ARM_OPADDSUB) Vars.Opcode.NewEncoding = Opcode.encoding ^ 0x0C00000;
 					Vars.Opcode.UseNewEncoding = true;
-				} else {
-					Logger::queueError(Logger::Error,L"Invalid shifted immediate %X",Vars.OriginalImmediate);
-					return false;
 				}
 			}
-			Vars.Immediate = temp;
+
+			if (!immediate.valid)
+			{
+				Logger::queueError(Logger::Error,L"Invalid shifted immediate %X",Vars.OriginalImmediate);
+				return false;
+			}
+
+			Vars.Immediate = immediate.value;
+			Vars.Shift.ShiftAmount = immediate.shiftAmount;
 		} else if (Opcode.flags & ARM_POOL)
 		{
-			int temp;
+			ArmImmediateEncodings encodings = encodeArmImmediate(Vars.Immediate);
 
-			if ((temp = getShiftedImmediate(Vars.Immediate,Vars.Shift.ShiftAmount)) != -1)
+			if (encodings.direct.valid)
 			{
 				// interpete ldr= as mov
 				Vars.Opcode.NewEncoding = 0x03A00000;
 				Vars.Opcode.UseNewEncoding = true;
 				Vars.Opcode.NewType = ARM_TYPE5;
 				Vars.Opcode.UseNewType = true;
-				Vars.Immediate = temp;
-			} else if ((temp = getShiftedImmediate(~Vars.Immediate,Vars.Shift.ShiftAmount)) != -1) 
+				Vars.Immediate = encodings.direct.value;
+				Vars.Shift.ShiftAmount = encodings.direct.shiftAmount;
+			} else if (encodings.inverted.valid)
 			{
 				// interprete ldr= as mvn
 				Vars.Opcode.NewEncoding = 0x03E00000;
 				Vars.Opcode.UseNewEncoding = true;
 				Vars.Opcode.NewType = ARM_TYPE5;
 				Vars.Opcode.UseNewType = true;
-				Vars.Immediate = temp;
+				Vars.Immediate = encodings.inverted.value;
+				Vars.Shift.ShiftAmount = encodings.inverted.shiftAmount;
 			} else {
 				Arm.addPoolValue(this,Vars.Immediate);
 			}
@@ -4,6 +4,25 @@
 #include "Archs/ARM/ArmOpcodes.h"
 #include "Core/Expression.h"
 
+// 8 bit value rotated by an even amount, the immediate operand of data
+// processing instructions
+struct ArmShiftedImmediate
+{
+	bool valid;
+	int value;
+	int shiftAmount;
+};
+
+struct ArmImmediateEncodings
+{
+	ArmShiftedImmediate direct;
+	ArmShiftedImmediate inverted;	// ~value, for mov/mvn and and/bic
+	ArmShiftedImmediate negated;	// -value, for add/sub and cmp/cmn
+};
+
+ArmShiftedImmediate encodeArmShiftedImmediate(uint32_t value);
+ArmImmediateEncodings encodeArmImmediate(uint32_t value);
+
 struct ArmOpcodeVariables {
 	struct {
 		unsigned char c,a;
@@ -71,7 +90,6 @@ public:
 private:
 	void FormatOpcode(char* Dest, const char* Source) const;
 	void FormatInstruction(const char* encoding, char* dest) const;
-	int getShiftedImmediate(unsigned int num, int& ShiftAmount);
 
 	ArmOpcodeVariables Vars;
 	tArmOpcode Opcode;
@@ -202,7 +202,11 @@ bool MipsElfFile::load(const fs::path& fileName, const fs::path& outputFileName)
 {
 	this->outputFileName = outputFileName;
 
-	if (!elf.load(fileName,true))
+	bool loaded = elf.load(fileName,true);
+	for (const std::wstring& error: elf.getErrors())
+		Logger::printError(Logger::Error,L"%s",error);
+
+	if (!loaded)
 	{
 		Logger::printError(Logger::FatalError,L"Failed to load %s",fileName);
 		return false;
@@ -258,6 +262,14 @@ bool MipsElfFile::setSection(const std::wstring& name)
 
 void MipsElfFile::save()
 {
+	if (Global.dryRun)
+	{
+		elf.buildFileData();
+		ByteArray& data = elf.getFileData();
+		Global.dryRunOutputs.open(outputFileName,fs::path()).write(0,data.data(),data.size());
+		return;
+	}
+
 	elf.save(outputFileName);
 }
 
@@ -270,6 +282,8 @@ DirectiveLoadMipsElf::DirectiveLoadMipsElf(const fs::path& fileName)
 	file = std::make_shared<MipsElfFile>();
 
 	this->inputName = getFullPathName(fileName);
+	Global.dependencies.addInput(this->inputName);
+	Global.dependencies.addOutput(this->inputName);
 	if (!file->load(this->inputName,this->inputName))
 	{
 		file = nullptr;
@@ -285,6 +299,8 @@ DirectiveLoadMipsElf::DirectiveLoadMipsElf(const fs::path& inputName, const fs::
 
 	this->inputName = getFullPathName(inputName);
 	this->outputName = getFullPathName(outputName);
+	Global.dependencies.addInput(this->inputName);
+	Global.dependencies.addOutput(this->outputName);
 	if (!file->load(this->inputName,this->outputName))
 	{
 		file = nullptr;
@@ -7,7 +7,7 @@
 	if (getExpFuncParameter(params,index,dest,funcName,false) == false) \
 		return ExpressionValue();
 
-ExpressionValue expFuncHi(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncHi(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	int64_t value;
 
@@ -16,7 +16,7 @@ ExpressionValue expFuncHi(const std::wstring& funcName, const std::vector<Expres
 	return ExpressionValue((int64_t)((value >> 16) + ((value & 0x8000) != 0)) & 0xFFFF);
 }
 
-ExpressionValue expFuncLo(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncLo(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	int64_t value;
 
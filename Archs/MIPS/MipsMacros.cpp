@@ -45,7 +45,7 @@ void MipsMacroCommand::Encode() const
 
 void MipsMacroCommand::writeTempData(TempData& tempData) const
 {
-	content->applyFileInfo();
+	content->applyFileInfo(tempData);
 	content->writeTempData(tempData);
 }
 
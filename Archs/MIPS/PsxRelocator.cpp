@@ -325,6 +325,7 @@ checkothertype:
 
 bool PsxRelocator::init(const fs::path& inputName)
 {
+	Global.dependencies.addInput(fs::absolute(inputName).lexically_normal());
 	auto inputFiles = loadPsxLibrary(inputName);
 	if (inputFiles.size() == 0)
 	{
@@ -557,7 +558,7 @@ void PsxRelocator::writeSymbols(SymbolData& symData) const
 
 DirectivePsxObjImport::DirectivePsxObjImport(const fs::path& fileName)
 {
-	if (rel.init(fileName))
+	if (rel.init(getAbsolutePath(fileName)))
 	{
 	}
 }
@@ -1,6 +1,7 @@
 #include "Commands/CAssemblerCommand.h"
 
 #include "Core/Common.h"
+#include "Core/Misc.h"
 
 CAssemblerCommand::CAssemblerCommand()
 {
@@ -14,3 +15,8 @@ void CAssemblerCommand::applyFileInfo()
 	Global.FileInfo.FileNum = FileNum;
 	Global.FileInfo.LineNumber = FileLine;
 }
+
+void CAssemblerCommand::applyFileInfo(TempData& tempData) const
+{
+	tempData.setFileInfo(FileNum,FileLine);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Util/MemoryStats.h"
+
 class TempData;
 class SymbolData;
 
@@ -10,7 +12,7 @@ struct ValidateState
 	int passes = 0;
 };
 
-class CAssemblerCommand
+class CAssemblerCommand: public MemoryTrackedHeap<MemoryCategory::Commands>
 {
 public:
 	CAssemblerCommand();
@@ -20,7 +22,10 @@ public:
 	virtual void writeTempData(TempData& tempData) const = 0;
 	virtual void writeSymData(SymbolData& symData) const { };
 	void applyFileInfo();
+	void applyFileInfo(TempData& tempData) const;
 	int getSection() { return section; }
+	int getFileNum() const { return FileNum; }
+	int getFileLine() const { return FileLine; }
 	void updateSection(int num) { section = num; }
 protected:
 	int FileNum;
@@ -97,14 +97,14 @@ void CAssemblerLabel::Encode() const
 
 void CAssemblerLabel::writeTempData(TempData& tempData) const
 {
-	if (!Global.symbolTable.isGeneratedLabel(label->getName()))
+	if (!label->isGenerated())
 		tempData.writeLine(label->getValue(),tfm::format(L"%s:",label->getName()));
 }
 
 void CAssemblerLabel::writeSymData(SymbolData& symData) const
 {
 	// TODO: find a less ugly way to check for undefined memory positions
-	if (label->getValue() == -1 || Global.symbolTable.isGeneratedLabel(label->getName()))
+	if (label->getValue() == -1 || label->isGenerated())
 		return;
 
 	symData.addLabel(label->getValue(),label->getOriginalName());
@@ -147,7 +147,7 @@ void CDirectiveFunction::Encode() const
 void CDirectiveFunction::writeTempData(TempData& tempData) const
 {
 	label->writeTempData(tempData);
-	content->applyFileInfo();
+	content->applyFileInfo(tempData);
 	content->writeTempData(tempData);
 }
 
@@ -151,7 +151,7 @@ void CDirectiveArea::writeTempData(TempData& tempData) const
 		tempData.writeLine(position,tfm::format(L".%S 0x%08X",directiveType,areaSize));
 	if (content)
 	{
-		content->applyFileInfo();
+		content->applyFileInfo(tempData);
 		content->writeTempData(tempData);
 	}
 
@@ -209,16 +209,22 @@ bool CDirectiveAutoRegion::Validate(const ValidateState &state)
 	contentValidation.noFileChange = true;
 	contentValidation.noFileChangeDirective = L"region";
 
-	// We need at least one full pass run before we can get an address.
-	if (state.passes < 1)
+	auto calculateContentSize = [&]()
 	{
-		// Just calculate contentSize.
 		position = g_fileManager->getVirtualAddress();
 		content->applyFileInfo();
 		content->Validate(contentValidation);
 		contentSize = g_fileManager->getVirtualAddress() - position;
 
+		applyFileInfo();
 		g_fileManager->seekVirtual(resetPosition);
+	};
+
+	// We need at least one full pass run before we can get an address.
+	if (state.passes < 1 && !Allocations::isBestFitPacking())
+	{
+		// Just calculate contentSize.
+		calculateContentSize();
 		return true;
 	}
 
@@ -227,25 +233,39 @@ bool CDirectiveAutoRegion::Validate(const ValidateState &state)
 
 	int64_t minRange = -1;
 	int64_t maxRange = -1;
-	if (minRangeExpression.isLoaded())
+	if ((minRangeExpression.isLoaded() && !minRangeExpression.evaluateInteger(minRange)) ||
+		(maxRangeExpression.isLoaded() && !maxRangeExpression.evaluateInteger(maxRange)))
 	{
-		if (!minRangeExpression.evaluateInteger(minRange))
+		// labels used in the range may not be known in the first pass
+		if (state.passes < 1)
 		{
-			Logger::queueError(Logger::Error, L"Invalid range expression for .autoregion");
-			return false;
+			calculateContentSize();
+			return true;
 		}
+
+		Logger::queueError(Logger::Error, L"Invalid range expression for .autoregion");
+		return false;
 	}
-	if (maxRangeExpression.isLoaded())
+
+	fileID = g_fileManager->getOpenFileID();
+	if (Allocations::isBestFitPacking())
 	{
-		if (!maxRangeExpression.evaluateInteger(maxRange))
+		// new or grown requests are placed at the start of the next pass,
+		// until then only their size is needed
+		bool planned;
+		if (!Allocations::allocatePackedSubArea(this, fileID, position, minRange, maxRange, contentSize, planned))
 		{
-			Logger::queueError(Logger::Error, L"Invalid range expression for .autoregion");
+			if (!planned)
+			{
+				calculateContentSize();
+				Allocations::requestSubArea(this, fileID, minRange, maxRange, contentSize);
+				return true;
+			}
+
+			Logger::queueError(Logger::Error, L"No space available for .autoregion of size %d", contentSize);
 			return false;
 		}
-	}
-
-	fileID = g_fileManager->getOpenFileID();
-	if (!Allocations::allocateSubArea(fileID, position, minRange, maxRange, contentSize))
+	} else if (!Allocations::allocateSubArea(fileID, position, minRange, maxRange, contentSize))
 	{
 		Logger::queueError(Logger::Error, L"No space available for .autoregion of size %d", contentSize);
 		return false;
@@ -279,7 +299,7 @@ void CDirectiveAutoRegion::Encode() const
 void CDirectiveAutoRegion::writeTempData(TempData& tempData) const
 {
 	tempData.writeLine(position,tfm::format(L".autoregion 0x%08X",position));
-	content->applyFileInfo();
+	content->applyFileInfo(tempData);
 	content->writeTempData(tempData);
 	tempData.writeLine(position+contentSize,L".endautoregion");
 }
@@ -100,11 +100,11 @@ void CDirectiveConditional::writeTempData(TempData& tempData) const
 {
 	if (previousResult)
 	{
-		ifBlock->applyFileInfo();
+		ifBlock->applyFileInfo(tempData);
 		ifBlock->writeTempData(tempData);
 	} else if (elseBlock != nullptr)
 	{
-		elseBlock->applyFileInfo();
+		elseBlock->applyFileInfo(tempData);
 		elseBlock->writeTempData(tempData);
 	}
 }
@@ -15,6 +15,7 @@
 TableCommand::TableCommand(const std::wstring& fileName, TextFile::Encoding encoding)
 {
 	auto fullName = getFullPathName(fileName);
+	Global.dependencies.addInput(fullName);
 
 	if (!fs::exists(fullName))
 	{
@@ -49,7 +50,7 @@ CDirectiveData::CDirectiveData()
 
 CDirectiveData::~CDirectiveData()
 {
-
+	MemoryStats::release(MemoryCategory::EncodedData,normalData.capacity());
 }
 
 void CDirectiveData::setNormal(std::vector<Expression>& entries, size_t unitSize)
@@ -75,7 +76,10 @@ void CDirectiveData::setNormal(std::vector<Expression>& entries, size_t unitSize
 	
 	this->entries = entries;
 	this->writeTermination = false;
-	normalData.reserve(entries.size());
+
+	size_t oldCapacity = normalData.capacity();
+	normalData.reserve(entries.size()*unitSize);
+	MemoryStats::resize(MemoryCategory::EncodedData,oldCapacity,normalData.capacity());
 }
 
 void CDirectiveData::setFloat(std::vector<Expression>& entries)
@@ -151,7 +155,7 @@ size_t CDirectiveData::getDataSize() const
 	case EncodingMode::U64:
 	case EncodingMode::Float:
 	case EncodingMode::Double:
-		return normalData.size()*getUnitSize();
+		return normalData.size();
 	case EncodingMode::Invalid:
 		break;
 	}
@@ -159,6 +163,29 @@ size_t CDirectiveData::getDataSize() const
 	return 0;
 }
 
+// stores little endian, the whole buffer is converted at once afterwards
+void CDirectiveData::appendValue(uint64_t value)
+{
+	size_t unitSize = getUnitSize();
+	for (size_t i = 0; i < unitSize; i++)
+		normalData.push_back((uint8_t) (value >> (i*8)));
+}
+
+uint64_t CDirectiveData::getValue(size_t index) const
+{
+	size_t unitSize = getUnitSize();
+	const uint8_t* data = &normalData[index*unitSize];
+
+	uint64_t value = 0;
+	for (size_t i = 0; i < unitSize; i++)
+	{
+		size_t shift = endianness == Endianness::Little ? i*8 : (unitSize-1-i)*8;
+		value |= (uint64_t) data[i] << shift;
+	}
+
+	return value;
+}
+
 void CDirectiveData::encodeCustom(EncodingTable& table)
 {
 	customData.clear();
@@ -176,10 +203,10 @@ void CDirectiveData::encodeCustom(EncodingTable& table)
 			customData.appendByte((byte)value.intValue);
 		} else if (value.isString())
 		{
-			ByteArray encoded = table.encodeString(value.strValue,false);
-			if (encoded.size() == 0 && value.strValue.size() > 0)
+			ByteArray encoded = table.encodeString(*value.strValue,false);
+			if (encoded.size() == 0 && value.strValue->size() > 0)
 			{
-				Logger::queueError(Logger::Error,L"Failed to encode \"%s\"",value.strValue);
+				Logger::queueError(Logger::Error,L"Failed to encode \"%s\"",*value.strValue);
 			}
 			customData.append(encoded);
 		} else {
@@ -242,19 +269,19 @@ void CDirectiveData::encodeFloat()
 		if (value.isInt() && mode == EncodingMode::Float)
 		{
 			int32_t num = getFloatBits((float)value.intValue);
-			normalData.push_back(num);
+			appendValue(num);
 		} else if (value.isInt() && mode == EncodingMode::Double)
 		{
 			int64_t num = getDoubleBits((double)value.intValue);
-			normalData.push_back(num);
+			appendValue(num);
 		} else if (value.isFloat() && mode == EncodingMode::Float)
 		{
 			int32_t num = getFloatBits((float)value.floatValue);
-			normalData.push_back(num);
+			appendValue(num);
 		} else if (value.isFloat() && mode == EncodingMode::Double)
 		{
 			int64_t num = getDoubleBits((double)value.floatValue);
-			normalData.push_back(num);
+			appendValue(num);
 		} else {
 			Logger::queueError(Logger::Error,L"Invalid expression type");
 		}
@@ -276,10 +303,10 @@ void CDirectiveData::encodeNormal()
 		if (value.isString())
 		{
 			bool hadNonAscii = false;
-			for (size_t l = 0; l < value.strValue.size(); l++)
+			for (size_t l = 0; l < value.strValue->size(); l++)
 			{
-				int64_t num = value.strValue[l];
-				normalData.push_back(num);
+				int64_t num = (*value.strValue)[l];
+				appendValue(num);
 
 				if (num >= 0x80 && !hadNonAscii)
 				{
@@ -290,14 +317,14 @@ void CDirectiveData::encodeNormal()
 		} else if (value.isInt())
 		{
 			int64_t num = value.intValue;
-			normalData.push_back(num);
+			appendValue(num);
 		} else if (value.isFloat() && mode == EncodingMode::U32)
 		{
 			int32_t num = getFloatBits((float)value.floatValue);
-			normalData.push_back(num);
+			appendValue(num);
 		} else if(value.isFloat() && mode == EncodingMode::U64) {
 			int64_t num = getDoubleBits((double)value.floatValue);
-			normalData.push_back(num);
+			appendValue(num);
 		} else {
 			Logger::queueError(Logger::Error,L"Invalid expression type");
 		}
@@ -305,7 +332,7 @@ void CDirectiveData::encodeNormal()
 
 	if (writeTermination)
 	{
-		normalData.push_back(0);
+		appendValue(0);
 	}
 }
 
@@ -314,6 +341,7 @@ bool CDirectiveData::Validate(const ValidateState &state)
 	position = g_fileManager->getVirtualAddress();
 
 	size_t oldSize = getDataSize();
+	size_t oldCapacity = normalData.capacity();
 	switch (mode)
 	{
 	case EncodingMode::U8:
@@ -338,6 +366,10 @@ bool CDirectiveData::Validate(const ValidateState &state)
 		break;
 	}
 
+	if (endianness == Endianness::Big && !normalData.empty())
+		swapEndianness(normalData.data(),normalData.size(),getUnitSize());
+
+	MemoryStats::resize(MemoryCategory::EncodedData,oldCapacity,normalData.capacity());
 	g_fileManager->advanceMemory(getDataSize());
 	return oldSize != getDataSize();
 }
@@ -352,30 +384,12 @@ void CDirectiveData::Encode() const
 		break;
 	case EncodingMode::U8:
 	case EncodingMode::Ascii:
-		for (auto value: normalData)
-		{
-			g_fileManager->writeU8((uint8_t)value);
-		}
-		break;
 	case EncodingMode::U16:
-		for (auto value: normalData)
-		{
-			g_fileManager->writeU16((uint16_t)value);
-		}
-		break;
 	case EncodingMode::U32:
 	case EncodingMode::Float:
-		for (auto value: normalData)
-		{
-			g_fileManager->writeU32((uint32_t)value);
-		}
-		break;
 	case EncodingMode::U64:
 	case EncodingMode::Double:
-		for (auto value: normalData)
-		{
-			g_fileManager->writeU64((uint64_t)value);
-		}
+		g_fileManager->write((void*) normalData.data(),normalData.size());
 		break;
 	case EncodingMode::Invalid:
 		// TODO: Assert?
@@ -385,6 +399,7 @@ void CDirectiveData::Encode() const
 
 void CDirectiveData::writeTempData(TempData& tempData) const
 {
+	size_t count = getUnitSize() != 0 ? getDataSize()/getUnitSize() : 0;
 	size_t size = (getUnitSize()*2+3)*getDataSize()+20;
 	wchar_t* str = new wchar_t[size];
 	wchar_t* start = str;
@@ -404,35 +419,35 @@ void CDirectiveData::writeTempData(TempData& tempData) const
 	case EncodingMode::Ascii:
 		str += swprintf(str,20,L".byte ");
 		
-		for (size_t i = 0; i < normalData.size(); i++)
+		for (size_t i = 0; i < count; i++)
 		{
-			str += swprintf(str,20,L"0x%02X,",(uint8_t)normalData[i]);
+			str += swprintf(str,20,L"0x%02X,",(uint8_t)getValue(i));
 		}
 		break;
 	case EncodingMode::U16:
 		str += swprintf(str,20,L".halfword ");
 
-		for (size_t i = 0; i < normalData.size(); i++)
+		for (size_t i = 0; i < count; i++)
 		{
-			str += swprintf(str,20,L"0x%04X,",(uint16_t)normalData[i]);
+			str += swprintf(str,20,L"0x%04X,",(uint16_t)getValue(i));
 		}
 		break;
 	case EncodingMode::U32:
 	case EncodingMode::Float:
 		str += swprintf(str,20,L".word ");
 
-		for (size_t i = 0; i < normalData.size(); i++)
+		for (size_t i = 0; i < count; i++)
 		{
-			str += swprintf(str,20,L"0x%08X,",(uint32_t)normalData[i]);
+			str += swprintf(str,20,L"0x%08X,",(uint32_t)getValue(i));
 		}
 		break;
 	case EncodingMode::U64:
 	case EncodingMode::Double:
 		str += swprintf(str,20,L".doubleword ");
 
-		for (size_t i = 0; i < normalData.size(); i++)
+		for (size_t i = 0; i < count; i++)
 		{
-			str += swprintf(str,20,L"0x%16llX,",(uint64_t)normalData[i]);
+			str += swprintf(str,20,L"0x%16llX,",(uint64_t)getValue(i));
 		}
 		break;
 	case EncodingMode::Invalid:
@@ -39,6 +39,8 @@ private:
 	void encodeFloat();
 	void encodeDouble();
 	void encodeNormal();
+	void appendValue(uint64_t value);
+	uint64_t getValue(size_t index) const;
 	size_t getUnitSize() const;
 	size_t getDataSize() const;
 	
@@ -47,6 +49,7 @@ private:
 	bool writeTermination;
 	std::vector<Expression> entries;
 	ByteArray customData;
-	std::vector<int64_t> normalData;
+	// packed at the unit size in target endianness, written as is
+	std::vector<uint8_t> normalData;
 	Endianness endianness;
 };
@@ -25,6 +25,8 @@ void CDirectiveFile::initOpen(const fs::path& fileName, int64_t memory)
 {
 	type = Type::Open;
 	fs::path fullName = getFullPathName(fileName);
+	Global.dependencies.addInput(fullName);
+	Global.dependencies.addOutput(fullName);
 
 	file = std::make_shared<GenericAssemblerFile>(fullName,memory,false);
 	g_fileManager->addFile(file);
@@ -36,6 +38,7 @@ void CDirectiveFile::initCreate(const fs::path& fileName, int64_t memory)
 {
 	type = Type::Create;
 	fs::path fullName = getFullPathName(fileName);
+	Global.dependencies.addOutput(fullName);
 
 	file = std::make_shared<GenericAssemblerFile>(fullName,memory,true);
 	g_fileManager->addFile(file);
@@ -48,7 +51,9 @@ void CDirectiveFile::initCopy(const fs::path& inputName, const fs::path& outputN
 	type = Type::Copy;
 	fs::path fullInputName = getFullPathName(inputName);
 	fs::path fullOutputName = getFullPathName(outputName);
-	
+	Global.dependencies.addInput(fullInputName);
+	Global.dependencies.addOutput(fullOutputName);
+
 	file = std::make_shared<GenericAssemblerFile>(fullOutputName,fullInputName,memory);
 	g_fileManager->addFile(file);
 
@@ -219,9 +224,10 @@ void CDirectivePosition::writeTempData(TempData& tempData) const
 //
 
 CDirectiveIncbin::CDirectiveIncbin(const fs::path& fileName)
-	: size(0), start(0)
+	: size(0), start(0), outputSize(0), compress(false), compressionType(CompressionType::Lz10)
 {
 	this->fileName = getFullPathName(fileName);
+	Global.dependencies.addInput(this->fileName);
 
 	if (!fs::exists(this->fileName))
 	{
@@ -229,7 +235,51 @@ CDirectiveIncbin::CDirectiveIncbin(const fs::path& fileName)
 	}
 
 	std::error_code error;
-	this->fileSize = static_cast<int64_t>(fs::file_size(fileName, error));
+	this->fileSize = static_cast<int64_t>(fs::file_size(this->fileName, error));
+}
+
+void CDirectiveIncbin::setCompression(CompressionType type)
+{
+	compress = true;
+	compressionType = type;
+
+	// the range is only known during validation if it depends on expressions
+	if (!startExpression.isLoaded() && !sizeExpression.isLoaded())
+	{
+		start = 0;
+		size = fileSize;
+		startCompression();
+	}
+}
+
+void CDirectiveIncbin::startCompression()
+{
+	compressionJob = std::make_shared<CompressionJob>();
+	compressionJob->start = start;
+	compressionJob->size = size;
+	compressionJob->valid = false;
+
+	std::shared_ptr<CompressionJob> job = compressionJob;
+	fs::path name = fileName;
+	CompressionType type = compressionType;
+
+	auto task = [job,name,type]()
+	{
+		ByteArray input;
+		if (job->size != 0)
+		{
+			input = ByteArray::fromFile(name,(long)job->start,job->size);
+			if ((int64_t) input.size() != job->size)
+				return;
+		}
+
+		job->valid = Global.compressionCache.compress(input,type,job->data);
+	};
+
+	if (Global.threadPool != nullptr)
+		Global.threadPool->submit(compressionJob->group,task);
+	else
+		task();
 }
 
 bool CDirectiveIncbin::Validate(const ValidateState &state)
@@ -270,13 +320,38 @@ bool CDirectiveIncbin::Validate(const ValidateState &state)
 		size = fileSize-start;
 	}
 
+	outputSize = size;
+	if (compress)
+	{
+		if (compressionJob == nullptr || compressionJob->start != start || compressionJob->size != size)
+			startCompression();
+
+		if (Global.threadPool != nullptr)
+			Global.threadPool->wait(compressionJob->group);
+
+		if (!compressionJob->valid)
+		{
+			Logger::queueError(Logger::Error,L"Could not compress file \"%s\"",fileName.wstring());
+			return false;
+		}
+
+		outputSize = compressionJob->data.size();
+	}
+
 	Arch->NextSection();
-	g_fileManager->advanceMemory(size);
+	g_fileManager->advanceMemory(outputSize);
 	return false;
 }
 
 void CDirectiveIncbin::Encode() const
 {
+	if (compress)
+	{
+		if (compressionJob != nullptr && compressionJob->valid)
+			g_fileManager->write(compressionJob->data.data(),compressionJob->data.size());
+		return;
+	}
+
 	if (size != 0)
 	{
 		ByteArray data = ByteArray::fromFile(fileName,(long)start,size);
@@ -291,12 +366,15 @@ void CDirectiveIncbin::Encode() const
 
 void CDirectiveIncbin::writeTempData(TempData& tempData) const
 {
-	tempData.writeLine(virtualAddress,tfm::format(L".incbin \"%s\"",fileName));
+	if (compress)
+		tempData.writeLine(virtualAddress,tfm::format(L".compress %s,\"%s\"",getCompressionTypeName(compressionType),fileName.wstring()));
+	else
+		tempData.writeLine(virtualAddress,tfm::format(L".incbin \"%s\"",fileName));
 }
 
 void CDirectiveIncbin::writeSymData(SymbolData& symData) const
 {
-	symData.addData(virtualAddress,size,SymbolData::Data8);
+	symData.addData(virtualAddress,outputSize,SymbolData::Data8);
 }
 
 
@@ -512,7 +590,7 @@ void CDirectiveHeaderSize::writeTempData(TempData& tempData) const
 DirectiveObjImport::DirectiveObjImport(const fs::path& inputName)
 {
 	ctor = nullptr;
-	if (rel.init(inputName))
+	if (rel.init(getAbsolutePath(inputName)))
 	{
 		rel.exportSymbols();
 	}
@@ -520,7 +598,7 @@ DirectiveObjImport::DirectiveObjImport(const fs::path& inputName)
 
 DirectiveObjImport::DirectiveObjImport(const fs::path& inputName, const std::wstring& ctorName)
 {
-	if (rel.init(inputName))
+	if (rel.init(getAbsolutePath(inputName)))
 	{
 		rel.exportSymbols();
 		ctor = rel.generateCtor(ctorName);
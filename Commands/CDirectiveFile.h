@@ -3,7 +3,9 @@
 #include "Commands/CAssemblerCommand.h"
 #include "Core/ELF/ElfRelocator.h"
 #include "Core/Expression.h"
+#include "Util/Compression.h"
 #include "Util/FileSystem.h"
+#include "Util/ThreadPool.h"
 
 class AssemblerFile;
 class GenericAssemblerFile;
@@ -53,12 +55,26 @@ public:
 	CDirectiveIncbin(const fs::path& fileName);
 	void setStart(Expression& exp) { startExpression = exp; };
 	void setSize(Expression& exp) { sizeExpression = exp; };
+	void setCompression(CompressionType type);
 
 	bool Validate(const ValidateState &state) override;
 	void Encode() const override;
 	void writeTempData(TempData& tempData) const override;
 	void writeSymData(SymbolData& symData) const override;
 private:
+	// compression runs on the thread pool, so all files included
+	// with a fixed range are compressed in parallel while parsing
+	struct CompressionJob
+	{
+		TaskGroup group;
+		int64_t start;
+		int64_t size;
+		bool valid;
+		ByteArray data;
+	};
+
+	void startCompression();
+
 	fs::path fileName;
 	int64_t fileSize;
 
@@ -66,7 +82,12 @@ private:
 	Expression sizeExpression;
 	int64_t size;
 	int64_t start;
+	int64_t outputSize;
 	int64_t virtualAddress;
+
+	bool compress;
+	CompressionType compressionType;
+	std::shared_ptr<CompressionJob> compressionJob;
 };
 
 class CDirectiveAlignFill: public CAssemblerCommand
@@ -1,5 +1,20 @@
 #include "Commands/CommandSequence.h"
 
+#include "Core/Common.h"
+#include "Core/Misc.h"
+#include "Core/ValidationTrace.h"
+#include "Util/Profiler.h"
+#include "Util/ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+	// sequences shorter than this are written directly, splitting them
+	// costs more than formatting the lines
+	const size_t minTempDataChunkSize = 256;
+}
+
 CommandSequence::CommandSequence()
 	: CAssemblerCommand()
 {
@@ -9,12 +24,20 @@ CommandSequence::CommandSequence()
 bool CommandSequence::Validate(const ValidateState &state)
 {
 	bool result = false;
+	Profiler::MacroScope macroScope(ProfilePhase::Validate,profileMacro);
 	
 	for (const std::unique_ptr<CAssemblerCommand>& cmd: commands)
 	{
+		Profiler::LineScope lineScope(ProfilePhase::Validate,cmd->getFileNum(),cmd->getFileLine());
+
 		cmd->applyFileInfo();
+		size_t traceChanges = ValidationTrace::getChangeCount();
 		if (cmd->Validate(state))
+		{
+			lineScope.markChanged();
+			ValidationTrace::commandChanged(cmd->getFileNum(),cmd->getFileLine(),traceChanges);
 			result = true;
+		}
 	}
 
 	return result;
@@ -22,18 +45,53 @@ bool CommandSequence::Validate(const ValidateState &state)
 
 void CommandSequence::Encode() const
 {
+	Profiler::MacroScope macroScope(ProfilePhase::Encode,profileMacro);
+
 	for (const std::unique_ptr<CAssemblerCommand>& cmd: commands)
 	{
+		Profiler::LineScope lineScope(ProfilePhase::Encode,cmd->getFileNum(),cmd->getFileLine());
 		cmd->Encode();
 	}
 }
 
 void CommandSequence::writeTempData(TempData& tempData) const
 {
-	for (const std::unique_ptr<CAssemblerCommand>& cmd: commands)
+	size_t chunkCount = 1;
+	if (Global.threadPool != nullptr && Global.threadPool->isMultiThreaded())
 	{
-		cmd->applyFileInfo();
-		cmd->writeTempData(tempData);
+		chunkCount = std::min(commands.size()/minTempDataChunkSize,
+			Global.threadPool->getThreadCount()*4);
+	}
+
+	if (chunkCount <= 1)
+	{
+		writeTempData(tempData,0,commands.size());
+		return;
+	}
+
+	// format each range of commands into its own buffer and append the
+	// buffers in order, the output is the same as when written directly
+	size_t chunkSize = (commands.size()+chunkCount-1)/chunkCount;
+	std::vector<TempData> chunks(chunkCount);
+	Global.threadPool->parallelFor(chunkCount,[&](size_t index)
+	{
+		size_t begin = index*chunkSize;
+		size_t end = std::min(begin+chunkSize,commands.size());
+
+		chunks[index].startChunk();
+		writeTempData(chunks[index],begin,end);
+	});
+
+	for (const TempData& chunk: chunks)
+		tempData.appendChunk(chunk);
+}
+
+void CommandSequence::writeTempData(TempData& tempData, size_t begin, size_t end) const
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		commands[i]->applyFileInfo(tempData);
+		commands[i]->writeTempData(tempData);
 	}
 }
 
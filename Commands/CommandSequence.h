@@ -16,6 +16,10 @@ public:
 	void writeTempData(TempData& tempData) const override;
 	void writeSymData(SymbolData& symData) const override;
 	void addCommand(std::unique_ptr<CAssemblerCommand> cmd) { commands.push_back(std::move(cmd)); }
+	void setProfileMacro(int id) { profileMacro = id; }
 private:
+	void writeTempData(TempData& tempData, size_t begin, size_t end) const;
+
 	std::vector<std::unique_ptr<CAssemblerCommand>> commands;
+	int profileMacro = -1;
 };
@@ -1,15 +1,25 @@
 #include "Core/Allocations.h"
 
 #include "Core/Common.h"
+#include "Core/FileManager.h"
 #include "Core/Misc.h"
+#include "Util/Util.h"
+
+#include <algorithm>
+#include <vector>
 
 std::map<Allocations::Key, Allocations::Usage> Allocations::allocations;
 std::map<Allocations::Key, int64_t> Allocations::pools;
 std::multimap<Allocations::Key, Allocations::SubArea> Allocations::subAreas;
+bool Allocations::bestFitPacking = false;
+std::map<const void*, Allocations::SubAreaRequest> Allocations::subAreaRequests;
+std::map<const void*, Allocations::SubAreaPlacement> Allocations::subAreaPlacements;
 
 void Allocations::clear()
 {
 	allocations.clear();
+	subAreaRequests.clear();
+	subAreaPlacements.clear();
 }
 
 void Allocations::setArea(int64_t fileID, int64_t position, int64_t space, int64_t usage, bool usesFill, bool shared)
@@ -71,9 +81,172 @@ bool Allocations::allocateSubArea(int64_t fileID, int64_t& position, int64_t min
 	return false;
 }
 
+void Allocations::requestSubArea(const void* owner, int64_t fileID, int64_t minRange, int64_t maxRange, int64_t size)
+{
+	auto it = subAreaRequests.find(owner);
+	size_t order = it != subAreaRequests.end() ? it->second.order : subAreaRequests.size();
+	subAreaRequests[owner] = SubAreaRequest{ order, fileID, minRange, maxRange, size };
+}
+
+bool Allocations::allocatePackedSubArea(const void* owner, int64_t fileID, int64_t& position, int64_t minRange, int64_t maxRange, int64_t size, bool& planned)
+{
+	requestSubArea(owner, fileID, minRange, maxRange, size);
+
+	// the placement stays usable as long as the content doesn't grow
+	auto it = subAreaPlacements.find(owner);
+	planned = it != subAreaPlacements.end() && it->second.request.fileID == fileID &&
+		it->second.request.minRange == minRange && it->second.request.maxRange == maxRange &&
+		it->second.request.size >= size;
+
+	if (!planned || !it->second.found)
+		return false;
+
+	const SubAreaPlacement& placement = it->second;
+	position = placement.position;
+	subAreas.emplace(placement.region, SubArea{ placement.position - placement.region.position, size });
+	return true;
+}
+
+void Allocations::planSubAreas()
+{
+	struct RegionSpace
+	{
+		Key key;
+		int64_t start;
+		int64_t end;
+		int64_t free;
+		std::vector<std::pair<int64_t,int64_t>> used;
+	};
+
+	std::vector<RegionSpace> regions;
+	for (auto it : allocations)
+	{
+		if (!it.second.shared)
+			continue;
+
+		int64_t start = it.first.position + it.second.usage;
+		int64_t end = it.first.position + it.second.space;
+		regions.push_back(RegionSpace{ it.first, start, end, end - start, {} });
+	}
+
+	auto inRange = [](const SubAreaRequest& request, int64_t position)
+	{
+		return (request.minRange == -1 || position >= request.minRange) &&
+			(request.maxRange == -1 || position <= request.maxRange);
+	};
+
+	// lowest position in a free gap of the region, or -1
+	auto findGap = [](const RegionSpace& region, const SubAreaRequest& request)
+	{
+		int64_t cursor = region.start;
+		for (size_t i = 0; i <= region.used.size(); i++)
+		{
+			int64_t gapEnd = i < region.used.size() ? region.used[i].first : region.end;
+			int64_t position = request.minRange != -1 ? std::max(cursor, request.minRange) : cursor;
+			if (request.maxRange != -1 && position > request.maxRange)
+				return (int64_t) -1;
+			if (position + request.size <= gapEnd)
+				return position;
+
+			if (i < region.used.size())
+				cursor = std::max(cursor, region.used[i].second);
+		}
+
+		return (int64_t) -1;
+	};
+
+	auto reserve = [](RegionSpace& region, int64_t position, int64_t size)
+	{
+		auto pos = std::lower_bound(region.used.begin(), region.used.end(), std::make_pair(position, position + size));
+		region.used.insert(pos, std::make_pair(position, position + size));
+		region.free -= size;
+	};
+
+	// largest first, ties in source order
+	std::vector<std::pair<const void*, SubAreaRequest>> requests(subAreaRequests.begin(), subAreaRequests.end());
+	std::sort(requests.begin(), requests.end(), [](const auto& a, const auto& b)
+	{
+		return std::tie(b.second.size, a.second.order) < std::tie(a.second.size, b.second.order);
+	});
+
+	std::map<const void*, SubAreaPlacement> newPlacements;
+
+	// keep all previous placements that are still valid
+	for (const auto& entry : requests)
+	{
+		const SubAreaRequest& request = entry.second;
+		auto old = subAreaPlacements.find(entry.first);
+		if (old == subAreaPlacements.end() || !old->second.found || !inRange(request, old->second.position))
+			continue;
+
+		int64_t start = old->second.position;
+		int64_t end = start + request.size;
+		for (RegionSpace& region : regions)
+		{
+			if (!(region.key.fileID == old->second.region.fileID && region.key.position == old->second.region.position))
+				continue;
+			if (start < region.start || end > region.end)
+				break;
+
+			bool overlaps = false;
+			for (const auto& used : region.used)
+				overlaps = overlaps || (start < used.second && used.first < end);
+			if (overlaps)
+				break;
+
+			reserve(region, start, request.size);
+			newPlacements[entry.first] = SubAreaPlacement{ request, true, region.key, start };
+			break;
+		}
+	}
+
+	// place the rest into the region that leaves the least space unused
+	for (const auto& entry : requests)
+	{
+		if (newPlacements.find(entry.first) != newPlacements.end())
+			continue;
+
+		const SubAreaRequest& request = entry.second;
+		RegionSpace* bestRegion = nullptr;
+		int64_t bestPosition = -1;
+
+		for (RegionSpace& region : regions)
+		{
+			if (region.key.fileID != request.fileID || region.free < request.size)
+				continue;
+			if (bestRegion != nullptr && region.free >= bestRegion->free)
+				continue;
+
+			int64_t position = findGap(region, request);
+			if (position == -1)
+				continue;
+
+			bestRegion = &region;
+			bestPosition = position;
+		}
+
+		if (bestRegion == nullptr)
+		{
+			newPlacements[entry.first] = SubAreaPlacement{ request, false, Key{ -1, -1 }, -1 };
+			continue;
+		}
+
+		reserve(*bestRegion, bestPosition, request.size);
+		newPlacements[entry.first] = SubAreaPlacement{ request, true, bestRegion->key, bestPosition };
+	}
+
+	subAreaPlacements = std::move(newPlacements);
+}
+
 void Allocations::clearSubAreas()
 {
 	subAreas.clear();
+
+	if (bestFitPacking && !subAreaRequests.empty())
+	{
+		planSubAreas();
+		subAreaRequests.clear();
+	}
 }
 
 int64_t Allocations::getSubAreaUsage(int64_t fileID, int64_t position)
@@ -220,3 +393,176 @@ void Allocations::collectPoolStats(AllocationStats &stats)
 		stats.totalPoolSize += it.second;
 	}
 }
+
+std::vector<AllocationMapEntry> Allocations::collectMap()
+{
+	std::vector<AllocationMapEntry> result;
+
+	for (auto it : allocations)
+	{
+		AllocationMapEntry entry;
+		entry.type = it.second.shared ? AllocationMapEntry::Type::Region : AllocationMapEntry::Type::Area;
+		entry.fileID = it.first.fileID;
+		entry.position = it.first.position;
+		entry.space = it.second.space;
+		entry.usage = it.second.usage;
+		entry.usesFill = it.second.usesFill;
+
+		std::vector<AllocationRange> used;
+		used.push_back(AllocationRange{ entry.position, entry.usage });
+
+		auto range = subAreas.equal_range(it.first);
+		for (auto sub = range.first; sub != range.second; ++sub)
+		{
+			AllocationRange subArea{ entry.position + sub->second.offset, sub->second.size };
+			entry.subAreas.push_back(subArea);
+			used.push_back(subArea);
+		}
+
+		std::sort(used.begin(), used.end(), [](const AllocationRange& a, const AllocationRange& b)
+		{
+			return a.position < b.position;
+		});
+
+		// everything not covered by content or sub areas is free
+		int64_t end = entry.position + entry.space;
+		int64_t cursor = entry.position;
+		for (const AllocationRange& block : used)
+		{
+			if (block.position > cursor)
+				entry.freeRanges.push_back(AllocationRange{ cursor, std::min(block.position, end) - cursor });
+			cursor = std::max(cursor, block.position + block.size);
+			if (cursor >= end)
+				break;
+		}
+
+		if (cursor < end)
+			entry.freeRanges.push_back(AllocationRange{ cursor, end - cursor });
+
+		result.push_back(entry);
+	}
+
+	for (auto it : pools)
+	{
+		AllocationMapEntry entry;
+		entry.type = AllocationMapEntry::Type::Pool;
+		entry.fileID = it.first.fileID;
+		entry.position = it.first.position;
+		entry.space = it.second;
+		entry.usage = it.second;
+		entry.usesFill = false;
+		result.push_back(entry);
+	}
+
+	return result;
+}
+
+const wchar_t* Allocations::getTypeName(AllocationMapEntry::Type type)
+{
+	switch (type)
+	{
+	case AllocationMapEntry::Type::Area:
+		return L"area";
+	case AllocationMapEntry::Type::Region:
+		return L"region";
+	case AllocationMapEntry::Type::Pool:
+		return L"pool";
+	}
+
+	return L"";
+}
+
+static std::wstring formatRangeListJson(const std::vector<AllocationRange>& ranges)
+{
+	std::wstring result = L"[";
+	for (size_t i = 0; i < ranges.size(); i++)
+	{
+		if (i != 0)
+			result += L", ";
+		result += tfm::format(L"{ \"position\": %d, \"size\": %d }",ranges[i].position,ranges[i].size);
+	}
+
+	return result + L"]";
+}
+
+bool Allocations::writeMap(const fs::path& fileName)
+{
+	std::vector<AllocationMapEntry> entries = collectMap();
+
+	// group by output file, sorted by name so the order doesn't depend on addresses in memory
+	std::map<std::wstring, std::vector<const AllocationMapEntry*>> files;
+	for (const AllocationMapEntry& entry: entries)
+	{
+		files[g_fileManager->getReportName(entry.fileID)].push_back(&entry);
+	}
+
+	bool json = fileName.extension() == L".json";
+	std::wstring text;
+
+	if (json)
+		text += L"{\n  \"files\": [";
+
+	for (auto it = files.begin(); it != files.end(); ++it)
+	{
+		int64_t totalFree = 0;
+
+		if (json)
+		{
+			text += it == files.begin() ? L"\n" : L",\n";
+			text += tfm::format(L"    {\n      \"name\": \"%s\",\n      \"entries\": [",escapeJsonString(it->first));
+		} else {
+			text += tfm::format(L"%s\n",it->first);
+		}
+
+		for (size_t i = 0; i < it->second.size(); i++)
+		{
+			const AllocationMapEntry& entry = *it->second[i];
+			const wchar_t* typeName = getTypeName(entry.type);
+
+			int64_t free = 0;
+			for (const AllocationRange& range: entry.freeRanges)
+				free += range.size;
+			totalFree += free;
+
+			if (json)
+			{
+				text += i == 0 ? L"\n" : L",\n";
+				text += tfm::format(L"        { \"type\": \"%s\", \"position\": %d, \"size\": %d, \"usage\": %d, \"free\": %d, \"fill\": %s,\n",
+					typeName,entry.position,entry.space,entry.usage,free,entry.usesFill ? L"true" : L"false");
+				text += tfm::format(L"          \"subAreas\": %s,\n",formatRangeListJson(entry.subAreas));
+				text += tfm::format(L"          \"freeRanges\": %s }",formatRangeListJson(entry.freeRanges));
+				continue;
+			}
+
+			text += tfm::format(L"  %-7s %08llX-%08llX  size %08llX  used %08llX  free %08llX%s\n",typeName,
+				entry.position,entry.position+entry.space-1,entry.space,entry.usage,free,entry.usesFill ? L"  fill" : L"");
+
+			if (entry.type == AllocationMapEntry::Type::Pool)
+				continue;
+
+			if (entry.usage != 0)
+				text += tfm::format(L"    content %08llX-%08llX\n",entry.position,entry.position+entry.usage-1);
+			for (const AllocationRange& range: entry.subAreas)
+				text += tfm::format(L"    sub     %08llX-%08llX\n",range.position,range.position+range.size-1);
+			for (const AllocationRange& range: entry.freeRanges)
+				text += tfm::format(L"    free    %08llX-%08llX\n",range.position,range.position+range.size-1);
+		}
+
+		if (json)
+			text += tfm::format(L"\n      ],\n      \"totalFree\": %d\n    }",totalFree);
+		else
+			text += tfm::format(L"  total free %08llX\n",totalFree);
+	}
+
+	if (json)
+		text += L"\n  ]\n}\n";
+
+	std::string data = convertWStringToUtf8(text);
+
+	fs::ofstream stream(fileName, fs::ofstream::out | fs::ofstream::binary | fs::ofstream::trunc);
+	if (!stream.is_open())
+		return false;
+
+	stream.write(data.data(),data.size());
+	return !stream.fail();
+}
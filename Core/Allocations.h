@@ -1,7 +1,12 @@
 #pragma once
 
+#include "Util/FileSystem.h"
+
+#include <cstddef>
 #include <cstdint>
 #include <map>
+#include <tuple>
+#include <vector>
 
 struct AllocationStats
 {
@@ -27,6 +32,26 @@ struct AllocationStats
 	int64_t totalPoolSize;
 };
 
+struct AllocationRange
+{
+	int64_t position;
+	int64_t size;
+};
+
+struct AllocationMapEntry
+{
+	enum class Type { Area, Region, Pool };
+
+	Type type;
+	int64_t fileID;
+	int64_t position;
+	int64_t space;
+	int64_t usage;
+	bool usesFill;
+	std::vector<AllocationRange> subAreas;
+	std::vector<AllocationRange> freeRanges;
+};
+
 class Allocations
 {
 public:
@@ -39,10 +64,21 @@ public:
 
 	static void clearSubAreas();
 	static bool allocateSubArea(int64_t fileID, int64_t& position, int64_t minRange, int64_t maxRange, int64_t size);
+
+	// best fit packing collects all requests of a pass and places them by
+	// decreasing size at the start of the next one. planned is false if the
+	// request wasn't part of the last plan yet
+	static void setBestFitPacking(bool enabled) { bestFitPacking = enabled; }
+	static bool isBestFitPacking() { return bestFitPacking; }
+	static void requestSubArea(const void* owner, int64_t fileID, int64_t minRange, int64_t maxRange, int64_t size);
+	static bool allocatePackedSubArea(const void* owner, int64_t fileID, int64_t& position, int64_t minRange, int64_t maxRange, int64_t size, bool& planned);
 	static int64_t getSubAreaUsage(int64_t fileID, int64_t position);
 
 	static void validateOverlap();
 	static AllocationStats collectStats();
+	static std::vector<AllocationMapEntry> collectMap();
+	static const wchar_t* getTypeName(AllocationMapEntry::Type type);
+	static bool writeMap(const fs::path& fileName);
 
 private:
 	struct Key
@@ -69,8 +105,26 @@ private:
 		int64_t size;
 	};
 
+	struct SubAreaRequest
+	{
+		size_t order;
+		int64_t fileID;
+		int64_t minRange;
+		int64_t maxRange;
+		int64_t size;
+	};
+
+	struct SubAreaPlacement
+	{
+		SubAreaRequest request;
+		bool found;
+		Key region;
+		int64_t position;
+	};
+
 	static void collectAreaStats(AllocationStats &stats);
 	static void collectPoolStats(AllocationStats &stats);
+	static void planSubAreas();
 
 	static int64_t getSubAreaUsage(Key key)
 	{
@@ -80,4 +134,8 @@ private:
 	static std::map<Key, Usage> allocations;
 	static std::map<Key, int64_t> pools;
 	static std::multimap<Key, SubArea> subAreas;
+
+	static bool bestFitPacking;
+	static std::map<const void*, SubAreaRequest> subAreaRequests;
+	static std::map<const void*, SubAreaPlacement> subAreaPlacements;
 };
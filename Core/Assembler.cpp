@@ -5,12 +5,68 @@
 #include "Commands/CAssemblerCommand.h"
 #include "Core/Allocations.h"
 #include "Core/Common.h"
+#include "Core/Expression.h"
 #include "Core/FileManager.h"
 #include "Core/Misc.h"
+#include "Core/ResultCache.h"
 #include "Core/SymbolData.h"
+#include "Core/ValidationTrace.h"
 #include "Parser/Parser.h"
+#include "Parser/Prelude.h"
+#include "Util/MemoryStats.h"
+#include "Util/Profiler.h"
+#include "Util/ThreadPool.h"
 
-#include <thread>
+namespace
+{
+	// writes the output of a snippet into a buffer that starts at baseAddress
+	class SnippetFile: public AssemblerFile
+	{
+	public:
+		SnippetFile(ByteArray& output, int64_t baseAddress)
+			: output(output), baseAddress(baseAddress), address(baseAddress), opened(false) { }
+
+		bool open(bool onlyCheck) override
+		{
+			address = baseAddress;
+			opened = !onlyCheck;
+			if (opened)
+				output.clear();
+			return true;
+		}
+
+		void close() override { opened = false; }
+		bool isOpen() override { return opened; }
+
+		bool write(void* data, size_t length) override
+		{
+			if (address < baseAddress)
+				return false;
+
+			size_t pos = (size_t) (address-baseAddress);
+			if (pos+length > output.size())
+				output.reserveBytes(pos+length-output.size());
+
+			output.replaceBytes(pos,(byte*) data,length);
+			address += length;
+			return true;
+		}
+
+		int64_t getVirtualAddress() override { return address; }
+		int64_t getPhysicalAddress() override { return address-baseAddress; }
+		int64_t getHeaderSize() override { return baseAddress; }
+		bool seekVirtual(int64_t virtualAddress) override { address = virtualAddress; return true; }
+		bool seekPhysical(int64_t physicalAddress) override { address = physicalAddress+baseAddress; return true; }
+		bool hasFixedVirtualAddress() override { return true; }
+		const fs::path& getFileName() override { return fileName; }
+	private:
+		ByteArray& output;
+		int64_t baseAddress;
+		int64_t address;
+		bool opened;
+		fs::path fileName;
+	};
+}
 
 void AddFileName(const std::wstring& FileName)
 {
@@ -26,6 +82,9 @@ bool encodeAssembly(std::unique_ptr<CAssemblerCommand> content, SymbolData& symD
 	Arm.Pass2();
 	Mips.Pass2();
 
+	// output files can't become accessible during validation, check them once
+	g_fileManager->probeFiles();
+
 	ValidateState validation;
 	do	// loop until everything is constant
 	{
@@ -54,6 +113,8 @@ bool encodeAssembly(std::unique_ptr<CAssemblerCommand> content, SymbolData& symD
 		Arm.Revalidate();
 		Mips.Revalidate();
 
+		ValidationTrace::endPass(validation.passes,Revalidate);
+
 		if (Global.memoryMode)
 			g_fileManager->closeFile();
 
@@ -93,20 +154,13 @@ bool encodeAssembly(std::unique_ptr<CAssemblerCommand> content, SymbolData& symD
 
 	// writeTempData, writeSymData and encode all access the same
 	// memory but never change, so they can run in parallel
-	if (Global.multiThreading)
-	{
-		std::thread tempThread(writeTempData);
-		std::thread symThread(writeSymData);
+	TaskGroup outputTasks;
+	Global.threadPool->submit(outputTasks,writeTempData);
+	Global.threadPool->submit(outputTasks,writeSymData);
 
-		content->Encode();
+	content->Encode();
 
-		tempThread.join();
-		symThread.join();
-	} else {
-		writeTempData();
-		writeSymData();
-		content->Encode();
-	}
+	Global.threadPool->wait(outputTasks);
 
 	if (g_fileManager->hasOpenFile())
 	{
@@ -136,28 +190,128 @@ static void printStats(const AllocationStats &stats)
 	}
 }
 
-bool runArmips(ArmipsArguments& settings)
+static std::vector<std::wstring> getDryRunSummaries()
+{
+	std::vector<std::wstring> lines;
+	for (const DryRunSummary& summary: Global.dryRunOutputs.summarize())
+	{
+		std::wstring name = summary.fileName.lexically_proximate(getWorkingDirectory()).generic_wstring();
+		lines.push_back(tfm::format(L"%s: size 0x%08llX, crc32 0x%08X",name,summary.size,summary.crc32));
+		for (const auto& range: summary.modifiedRanges)
+			lines.push_back(tfm::format(L"  modified 0x%08llX-0x%08llX",range.first,range.second-1));
+	}
+
+	return lines;
+}
+
+static void printProfileLocations(const wchar_t* title, const std::vector<ProfileLocation>& locations)
+{
+	Logger::printLine(L"%s:",title);
+	Logger::printLine(L"  %10s %10s %10s %8s %10s %8s  %s",L"parse ms",L"valid. ms",L"encode ms",L"passes",L"evals",L"bytes",L"location");
+
+	for (const ProfileLocation& location: locations)
+	{
+		std::wstring name;
+		if (!location.name.empty())
+			name = location.name;
+		else if (location.line < 0)
+			name = Global.fileList.relativeWstring(location.fileNum);
+		else
+			name = tfm::format(L"%s line %d",Global.fileList.relativeWstring(location.fileNum),location.line);
+
+		const ProfileEntry& entry = location.entry;
+		Logger::printLine(L"  %10.3f %10.3f %10.3f %8d %10d %8d  %s",entry.time[(size_t)ProfilePhase::Parse],
+			entry.time[(size_t)ProfilePhase::Validate],entry.time[(size_t)ProfilePhase::Encode],
+			entry.revalidations,entry.evaluations,entry.bytes,name);
+	}
+}
+
+static void printProfile(size_t count)
+{
+	printProfileLocations(L"Hot lines",Profiler::getLines(count));
+	printProfileLocations(L"Hot files",Profiler::getFiles(count));
+	printProfileLocations(L"Hot macros",Profiler::getMacros(count));
+}
+
+static void printMemoryStats()
+{
+	Logger::printLine(L"Memory usage (current / peak):");
+	for (size_t i = 0; i < (size_t)MemoryCategory::Count; i++)
+	{
+		MemoryCategory category = (MemoryCategory)i;
+		MemoryCategoryStats stats = MemoryStats::get(category);
+		Logger::printLine(L"  %-14s%lld / %lld", MemoryStats::getCategoryName(category), stats.current, stats.peak);
+	}
+
+	MemoryCategoryStats total = MemoryStats::getTotal();
+	Logger::printLine(L"  %-14s%lld / %lld", L"Total", total.current, total.peak);
+}
+
+static void resetGlobalState()
 {
-	// initialize and reset global data
 	Global.Section = 0;
 	Global.nocash = false;
 	Global.FileInfo.TotalLineCount = 0;
 	Global.relativeInclude = false;
-	Global.multiThreading = true;
+	Global.skipUnchangedOutputs = false;
+	Global.dryRun = false;
+	Global.dryRunOutputs.clear();
+	Global.workingDirectory.clear();
 	Arch = &InvalidArchitecture;
 
 	Tokenizer::clearEquValues();
+	ExpressionValue::clearStrings();
 	Logger::clear();
 	Allocations::clear();
+	Allocations::setBestFitPacking(false);
 	Global.Table.clear();
 	Global.symbolTable.clear();
+	g_fileManager->clear();
 
 	Global.fileList.clear();
+	Global.dependencies.clear();
+	Global.compressionCache.clear();
+	Global.compressionCache.setDirectory(fs::path());
 	Global.FileInfo.TotalLineCount = 0;
 	Global.FileInfo.LineNumber = 0;
 	Global.FileInfo.FileNum = 0;
 
 	Arm.clear();
+}
+
+// for runs that stop before anything was collected
+static void stopCollecting()
+{
+	MemoryStats::setEnabled(false);
+	Profiler::setEnabled(false);
+	ValidationTrace::setEnabled(false);
+}
+
+bool runArmips(ArmipsArguments& settings)
+{
+	// initialize and reset global data
+	resetGlobalState();
+	Global.skipUnchangedOutputs = settings.skipUnchangedOutputs;
+	Global.dryRun = settings.dryRun;
+	Global.workingDirectory = settings.workingDirectory;
+
+	if (!settings.workingDirectory.empty())
+	{
+		for (fs::path* fileName: { &settings.inputFileName, &settings.tempFileName, &settings.symFileName,
+			&settings.dependencyFileName, &settings.freeMapFileName, &settings.compressionCacheDirectory,
+			&settings.resultCacheDirectory, &settings.preludeFileName, &settings.savePreludeFileName,
+			&settings.validationTraceFileName })
+		{
+			if (!fileName->empty())
+				*fileName = getAbsolutePath(*fileName);
+		}
+	}
+
+	Global.compressionCache.setDirectory(settings.compressionCacheDirectory);
+
+	MemoryStats::setEnabled(settings.showStats);
+	Profiler::setEnabled(settings.profileCount != 0);
+	ValidationTrace::setEnabled(!settings.validationTraceFileName.empty());
 
 	// process settings
 	Parser parser;
@@ -173,6 +327,32 @@ bool runArmips(ArmipsArguments& settings)
 	if (!settings.tempFileName.empty())
 		tempData.setFileName(settings.tempFileName);
 
+	// a valid cache entry replaces the whole run
+	std::unique_ptr<ResultCache> resultCache;
+	if (!settings.resultCacheDirectory.empty() && settings.mode == ArmipsMode::FILE && !settings.showStats && !settings.dryRun
+		&& settings.profileCount == 0 && settings.validationTraceFileName.empty())
+	{
+		resultCache = std::make_unique<ResultCache>(settings.resultCacheDirectory,settings);
+		if (resultCache->restore(settings.skipUnchangedOutputs))
+			return true;
+	}
+
+	if (!settings.preludeFileName.empty())
+		Global.dependencies.addInput(fs::absolute(settings.preludeFileName).lexically_normal());
+
+	std::vector<LabelDefinition> preludeLabels;
+	if (!settings.preludeFileName.empty() && !loadPrelude(settings.preludeFileName,parser,preludeLabels))
+	{
+		stopCollecting();
+		return false;
+	}
+
+	Global.symbolTable.addLabels(preludeLabels);
+	for (const LabelDefinition& label : preludeLabels)
+	{
+		symData.addLabel(label.value, label.originalName);
+	}
+
 	Token token;
 	for (size_t i = 0; i < settings.equList.size(); i++)
 	{
@@ -186,7 +366,10 @@ bool runArmips(ArmipsArguments& settings)
 	}
 
 	if (Logger::hasError())
+	{
+		stopCollecting();
 		return false;
+	}
 
 	// run assembler
 	TextFile input;
@@ -197,6 +380,7 @@ bool runArmips(ArmipsArguments& settings)
 		if (!input.open(settings.inputFileName,TextFile::Read))
 		{
 			Logger::printError(Logger::Error,L"Could not open file");
+			stopCollecting();
 			return false;
 		}
 		break;
@@ -207,12 +391,31 @@ bool runArmips(ArmipsArguments& settings)
 		break;
 	}
 
+	// all parallel work of this run is scheduled on the same pool
+	ThreadPool threadPool(settings.threadCount);
+	Global.threadPool = &threadPool;
+
 	std::unique_ptr<CAssemblerCommand> content = parser.parseFile(input);
 	Logger::printQueue();
 
+	// every label and data directive adds at most one entry
+	if (!settings.symFileName.empty())
+		symData.reserve(Global.symbolTable.getLabelCount(),parser.getCommandCount());
+
 	bool result = !Logger::hasError();
 	if (result && content != nullptr)
 		result = encodeAssembly(std::move(content), symData, tempData);
+
+	// the trace is most useful when validation didn't finish
+	if (!settings.validationTraceFileName.empty())
+	{
+		if (!ValidationTrace::write(settings.validationTraceFileName))
+		{
+			Logger::printError(Logger::Error,L"Could not write validation trace %s",settings.validationTraceFileName);
+			result = false;
+		}
+		ValidationTrace::setEnabled(false);
+	}
 	
 	if (g_fileManager->hasOpenFile())
 	{
@@ -221,16 +424,223 @@ bool runArmips(ArmipsArguments& settings)
 		g_fileManager->closeFile();
 	}
 
+	if (result && !settings.tempFileName.empty())
+		Global.dependencies.addOutput(fs::absolute(settings.tempFileName).lexically_normal());
+	if (result && !settings.symFileName.empty())
+		Global.dependencies.addOutput(fs::absolute(settings.symFileName).lexically_normal());
+
+	if (result && !settings.dependencyFileName.empty())
+	{
+		if (!Global.dependencies.write(settings.dependencyFileName,Global.fileList))
+		{
+			Logger::printError(Logger::Error,L"Could not write dependency file %s",settings.dependencyFileName);
+			result = false;
+		}
+	}
+
+	if (result && !settings.freeMapFileName.empty() && !Allocations::writeMap(settings.freeMapFileName))
+	{
+		Logger::printError(Logger::Error,L"Could not write free space map %s",settings.freeMapFileName);
+		result = false;
+	}
+
+	if (result && !settings.savePreludeFileName.empty() && !savePrelude(settings.savePreludeFileName,parser))
+	{
+		Logger::printError(Logger::Error,L"Could not write prelude %s",settings.savePreludeFileName);
+		result = false;
+	}
+
+	// only runs without any messages are cached, a restored run can't repeat them.
+	// inputs are hashed now, so they must not have changed since they were read
+	if (result && resultCache != nullptr && Logger::getErrors().empty() && !Global.dependencies.inputsChanged())
+	{
+		std::set<fs::path> inputs = Global.dependencies.getInputs(Global.fileList);
+		std::set<fs::path> outputs = Global.dependencies.getOutputs();
+
+		for (const fs::path& fileName: { settings.dependencyFileName, settings.freeMapFileName, settings.savePreludeFileName })
+		{
+			if (!fileName.empty())
+				outputs.insert(fs::absolute(fileName).lexically_normal());
+		}
+
+		resultCache->store(inputs,outputs);
+	}
+
+	if (settings.dryRun && settings.outputsResult != nullptr)
+		*settings.outputsResult = Global.dryRunOutputs.getContents();
+
+	if (result && settings.dryRun && settings.dryRunResult != nullptr)
+	{
+		*settings.dryRunResult = getDryRunSummaries();
+	} else if (result && settings.dryRun && settings.outputsResult == nullptr)
+	{
+		for (const std::wstring& line: getDryRunSummaries())
+			Logger::printLine(line);
+	}
+
 	// return errors
 	if (settings.errorsResult != nullptr)
 	{
-		std::vector<std::wstring> errors = Logger::getErrors();
-		for (size_t i = 0; i < errors.size(); i++)
-			settings.errorsResult->push_back(errors[i]);
+		const std::vector<std::wstring>& errors = Logger::getErrors();
+		settings.errorsResult->insert(settings.errorsResult->end(),errors.begin(),errors.end());
 	}
 
 	if (settings.showStats)
+	{
 		printStats(Allocations::collectStats());
+		printMemoryStats();
+		MemoryStats::setEnabled(false);
+	}
+
+	if (settings.profileCount != 0)
+	{
+		printProfile(settings.profileCount);
+		Profiler::setEnabled(false);
+	}
 
+	Global.threadPool = nullptr;
 	return result;
 }
+
+// the parse and architecture state a snippet can change. restoring it only
+// copies what the snippet actually changed
+struct AssemblerSession::Checkpoint
+{
+	CArchitecture* arch;
+	bool armThumb;
+	ArmArchType armVersion;
+	std::vector<ArmPoolEntry> armPool;
+	CMipsArchitecture mips;
+	EncodingTable table;
+	int section;
+	bool nocash;
+	bool relativeInclude;
+	bool bestFitPacking;
+};
+
+AssemblerSession::AssemblerSession()
+	: equValueCount(0), silent(true), initialized(false)
+{
+}
+
+AssemblerSession::~AssemblerSession()
+{
+}
+
+bool AssemblerSession::initialize(const std::wstring& setupCode, bool silent)
+{
+	resetGlobalState();
+	this->silent = silent;
+	initialized = false;
+
+	Logger::setSilent(silent);
+
+	parser = std::make_unique<Parser>();
+	threadPool = std::make_unique<ThreadPool>(1);
+
+	// the setup code is assembled once, its output is discarded
+	ByteArray setupOutput;
+	SymbolData symData;
+	TempData tempData;
+	Global.memoryMode = true;
+	Global.memoryFile = std::make_shared<SnippetFile>(setupOutput,0);
+	Global.threadPool = threadPool.get();
+
+	std::unique_ptr<CAssemblerCommand> content = parser->parseString(setupCode);
+	Logger::printQueue();
+
+	bool result = !Logger::hasError() && content != nullptr;
+	if (result)
+		result = encodeAssembly(std::move(content),symData,tempData);
+
+	if (g_fileManager->hasOpenFile())
+		g_fileManager->closeFile();
+
+	Global.memoryMode = false;
+	Global.memoryFile = nullptr;
+	Global.threadPool = nullptr;
+
+	if (!result)
+		return false;
+
+	Global.symbolTable.setCheckpoint();
+	equValueCount = Tokenizer::getEquValueCount();
+	parser->setCheckpoint();
+
+	checkpoint = std::make_unique<Checkpoint>();
+	checkpoint->arch = Arch;
+	checkpoint->armThumb = Arm.GetThumbMode();
+	checkpoint->armVersion = Arm.getVersion();
+	checkpoint->armPool = Arm.getPoolContent();
+	checkpoint->mips = Mips;
+	checkpoint->table = Global.Table;
+	checkpoint->section = Global.Section;
+	checkpoint->nocash = Global.nocash;
+	checkpoint->relativeInclude = Global.relativeInclude;
+	checkpoint->bestFitPacking = Allocations::isBestFitPacking();
+	initialized = true;
+	return true;
+}
+
+bool AssemblerSession::assemble(const std::wstring& code, int64_t address, ByteArray& output)
+{
+	output.clear();
+
+	Logger::clear();
+	Logger::setSilent(silent);
+
+	if (!initialized)
+	{
+		Logger::printError(Logger::Error,L"Assembler session not initialized");
+		return false;
+	}
+
+	Allocations::clear();
+
+	SymbolData symData;
+	TempData tempData;
+	Global.memoryMode = true;
+	Global.memoryFile = std::make_shared<SnippetFile>(output,address);
+	Global.threadPool = threadPool.get();
+
+	std::unique_ptr<CAssemblerCommand> content = parser->parseString(code);
+	Logger::printQueue();
+
+	bool result = !Logger::hasError() && content != nullptr;
+	if (result)
+		result = encodeAssembly(std::move(content),symData,tempData);
+
+	if (g_fileManager->hasOpenFile())
+		g_fileManager->closeFile();
+
+	Global.memoryMode = false;
+	Global.memoryFile = nullptr;
+	Global.threadPool = nullptr;
+
+	// forget everything the snippet defined
+	Global.symbolTable.rollback();
+	Tokenizer::truncateEquValues(equValueCount);
+	parser->rollback();
+
+	Arch = checkpoint->arch;
+	Arm.SetThumbMode(checkpoint->armThumb);
+	Arm.setVersion(checkpoint->armVersion);
+	if (checkpoint->armPool.empty())
+		Arm.clearPoolContent();
+	else
+		Arm.setPoolContent(checkpoint->armPool);
+	Mips = checkpoint->mips;
+	if (Global.Table.getRevision() != checkpoint->table.getRevision())
+		Global.Table = checkpoint->table;
+	Global.Section = checkpoint->section;
+	Global.nocash = checkpoint->nocash;
+	Global.relativeInclude = checkpoint->relativeInclude;
+	Allocations::setBestFitPacking(checkpoint->bestFitPacking);
+
+	return result;
+}
+
+const std::vector<std::wstring>& AssemblerSession::getErrors() const
+{
+	return Logger::getErrors();
+}
@@ -2,11 +2,15 @@
 
 #include "Util/FileSystem.h"
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 class AssemblerFile;
+class ByteArray;
+class Parser;
+class ThreadPool;
 
 #define ARMIPS_VERSION_MAJOR    0
 #define ARMIPS_VERSION_MINOR    11
@@ -35,7 +39,17 @@ struct ArmipsArguments
 	bool errorOnWarning;
 	bool silent;
 	bool showStats;
+	bool skipUnchangedOutputs;
+	bool dryRun;
+	size_t threadCount;
+	size_t profileCount;
 	std::vector<std::wstring>* errorsResult;
+	// receives the content of all outputs of a dry run
+	std::map<fs::path,ByteArray>* outputsResult;
+	// receives the summary lines of a dry run instead of printing them
+	std::vector<std::wstring>* dryRunResult;
+	// relative file names are resolved here instead of the current directory
+	fs::path workingDirectory;
 	std::vector<EquationDefinition> equList;
 	std::vector<LabelDefinition> labels;
 
@@ -43,6 +57,13 @@ struct ArmipsArguments
 	fs::path inputFileName;
 	fs::path tempFileName;
 	fs::path symFileName;
+	fs::path dependencyFileName;
+	fs::path freeMapFileName;
+	fs::path compressionCacheDirectory;
+	fs::path resultCacheDirectory;
+	fs::path validationTraceFileName;
+	fs::path preludeFileName;
+	fs::path savePreludeFileName;
 	bool useAbsoluteFileNames;
 
 	// memory mode
@@ -56,9 +77,42 @@ struct ArmipsArguments
 		errorOnWarning = false;
 		silent = false;
 		showStats = false;
+		skipUnchangedOutputs = false;
+		dryRun = false;
+		threadCount = 0;
+		profileCount = 0;
 		errorsResult = nullptr;
+		outputsResult = nullptr;
+		dryRunResult = nullptr;
 		useAbsoluteFileNames = true;
 	}
 };
 
 bool runArmips(ArmipsArguments& settings);
+
+// Keeps the state of a setup run (architecture, equs, labels, macros and
+// encoding table) and assembles small snippets against it into a buffer
+// without touching any files. Everything a snippet defines or changes is
+// restored to the state of the setup run afterwards, at a cost that depends
+// on the snippet and not on the setup code. Snippets still go through the
+// full parser, validation and encoding, the opcode parsers are not called
+// directly. Sessions and runArmips share the global assembler state, so
+// only one of them can be used at a time.
+class AssemblerSession
+{
+public:
+	AssemblerSession();
+	~AssemblerSession();
+	bool initialize(const std::wstring& setupCode, bool silent = true);
+	bool assemble(const std::wstring& code, int64_t address, ByteArray& output);
+	const std::vector<std::wstring>& getErrors() const;
+private:
+	struct Checkpoint;
+
+	std::unique_ptr<Parser> parser;
+	std::unique_ptr<Checkpoint> checkpoint;
+	std::unique_ptr<ThreadPool> threadPool;
+	size_t equValueCount;
+	bool silent;
+	bool initialized;
+};
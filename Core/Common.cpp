@@ -48,9 +48,155 @@ void FileList::clear()
 	_entries.clear();
 }
 
+DependencyList::FileStamp DependencyList::getStamp(const fs::path& path)
+{
+	FileStamp stamp = { false, 0, fs::file_time_type() };
+
+	std::error_code error;
+	if (!fs::is_regular_file(path,error))
+		return stamp;
+
+	stamp.size = fs::file_size(path,error);
+	if (!error)
+		stamp.time = fs::last_write_time(path,error);
+	stamp.exists = !error;
+	return stamp;
+}
+
+void DependencyList::addInput(const fs::path& path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (inputs.find(path) == inputs.end())
+		inputs[path] = getStamp(path);
+}
+
+bool DependencyList::inputsChanged() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (const auto& it: inputs)
+	{
+		FileStamp stamp = getStamp(it.first);
+		if (stamp.exists != it.second.exists || stamp.size != it.second.size || stamp.time != it.second.time)
+			return true;
+	}
+
+	return false;
+}
+
+void DependencyList::addOutput(const fs::path& path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	outputs.insert(path);
+}
+
+void DependencyList::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	inputs.clear();
+	outputs.clear();
+}
+
+static std::string escapeDependencyPath(const fs::path& path)
+{
+	std::string text = convertWStringToUtf8(path.generic_wstring());
+
+	std::string result;
+	for (char c: text)
+	{
+		switch (c)
+		{
+		case ' ':
+		case '#':
+			result += '\\';
+			break;
+		case '$':
+			result += '$';
+			break;
+		}
+
+		result += c;
+	}
+
+	return result;
+}
+
+std::set<fs::path> DependencyList::getInputs(const FileList& sourceFiles) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::set<fs::path> allInputs;
+	for (const auto& it: inputs)
+		allInputs.insert(it.first);
+	for (size_t i = 0; i < sourceFiles.size(); i++)
+		allInputs.insert(sourceFiles.path((int)i));
+
+	return allInputs;
+}
+
+std::set<fs::path> DependencyList::getOutputs() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return outputs;
+}
+
+bool DependencyList::write(const fs::path& fileName, const FileList& sourceFiles) const
+{
+	std::set<fs::path> allInputs = getInputs(sourceFiles);
+	std::set<fs::path> allOutputs = getOutputs();
+
+	std::string text;
+	if (allOutputs.empty())
+	{
+		text += escapeDependencyPath(fileName);
+	} else {
+		for (const fs::path& output: allOutputs)
+		{
+			if (&output != &*allOutputs.begin())
+				text += ' ';
+			text += escapeDependencyPath(output);
+		}
+	}
+
+	text += ':';
+
+	// files that were only probed change the output once they are created,
+	// so they are listed even if they don't exist
+	std::vector<const fs::path*> missingInputs;
+	for (const fs::path& input: allInputs)
+	{
+		if (allOutputs.find(input) != allOutputs.end())
+			continue;
+
+		text += " \\\n  ";
+		text += escapeDependencyPath(input);
+
+		std::error_code error;
+		if (!fs::exists(input,error))
+			missingInputs.push_back(&input);
+	}
+
+	text += '\n';
+
+	// empty rules for them so make doesn't stop because it can't build them
+	for (const fs::path* input: missingInputs)
+	{
+		text += '\n';
+		text += escapeDependencyPath(*input);
+		text += ":\n";
+	}
+
+	fs::ofstream stream(fileName, fs::ofstream::out | fs::ofstream::binary | fs::ofstream::trunc);
+	if (!stream.is_open())
+		return false;
+
+	stream.write(text.data(),text.size());
+	return !stream.fail();
+}
+
 FileList::Entry::Entry(const fs::path &path) :
 	_path(path),
-	_relativePath(path.lexically_proximate(fs::current_path())),
+	_relativePath(path.lexically_proximate(getWorkingDirectory())),
 	_string(_path.wstring()),
 	_relativeString(_relativePath.generic_wstring())
 {
@@ -76,16 +222,30 @@ const std::wstring &FileList::Entry::relativeWstring() const
 	return _relativeString;
 }
 
+fs::path getWorkingDirectory()
+{
+	if (!Global.workingDirectory.empty())
+		return Global.workingDirectory;
+	return fs::current_path();
+}
+
+fs::path getAbsolutePath(const fs::path& path)
+{
+	if (path.is_absolute())
+		return path.lexically_normal();
+	return (getWorkingDirectory() / path).lexically_normal();
+}
+
 fs::path getFullPathName(const fs::path& path)
 {
 	if (Global.relativeInclude && !path.is_absolute())
 	{
 		const fs::path &source = Global.fileList.path(Global.FileInfo.FileNum);
-		return fs::absolute(source.parent_path() / path).lexically_normal();
+		return getAbsolutePath(source.parent_path() / path);
 	}
 	else
 	{
-		return fs::absolute(path).lexically_normal();
+		return getAbsolutePath(path);
 	}
 }
 
@@ -1,14 +1,21 @@
 #pragma once
 
+#include "Core/DryRun.h"
 #include "Core/SymbolTable.h"
+#include "Util/Compression.h"
 #include "Util/EncodingTable.h"
 #include "Util/FileSystem.h"
 
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
 class AssemblerFile;
 class CArchitecture;
+class ThreadPool;
 
 class FileList
 {
@@ -44,6 +51,36 @@ private:
 	std::vector<Entry> _entries;
 };
 
+// all files read or written during a run, used to write a depfile.
+// inputs can be added from expression functions during encoding, so
+// access is synchronized. inputs have to be added before they are read
+class DependencyList
+{
+public:
+	void addInput(const fs::path& path);
+	void addOutput(const fs::path& path);
+	bool write(const fs::path& fileName, const FileList& sourceFiles) const;
+	std::set<fs::path> getInputs(const FileList& sourceFiles) const;
+	std::set<fs::path> getOutputs() const;
+	// true if an input changed its size or modification time since it was added
+	bool inputsChanged() const;
+	void clear();
+
+private:
+	struct FileStamp
+	{
+		bool exists;
+		uintmax_t size;
+		fs::file_time_type time;
+	};
+
+	static FileStamp getStamp(const fs::path& path);
+
+	mutable std::mutex mutex;
+	std::map<fs::path,FileStamp> inputs;
+	std::set<fs::path> outputs;
+};
+
 typedef struct {
 	int FileNum;
 	int LineNumber;
@@ -52,15 +89,21 @@ typedef struct {
 
 typedef struct {
 	FileList fileList;
+	DependencyList dependencies;
+	CompressionCache compressionCache;
 	tFileInfo FileInfo;
 	SymbolTable symbolTable;
 	EncodingTable Table;
 	int Section;
 	bool nocash;
 	bool relativeInclude;
+	bool skipUnchangedOutputs;
+	bool dryRun;
+	DryRunOutputs dryRunOutputs;
+	fs::path workingDirectory;
 	bool memoryMode;
 	std::shared_ptr<AssemblerFile> memoryFile;
-	bool multiThreading;
+	ThreadPool* threadPool;
 } tGlobal;
 
 extern tGlobal Global;
@@ -69,6 +112,9 @@ extern CArchitecture* Arch;
 class FileManager;
 extern FileManager* g_fileManager;
 
+// relative to the working directory of the run, or the current directory
+fs::path getWorkingDirectory();
+fs::path getAbsolutePath(const fs::path& path);
 fs::path getFullPathName(const fs::path& path);
 
 bool checkLabelDefined(const std::wstring& labelName, int section);
@@ -0,0 +1,164 @@
+#include "Core/DryRun.h"
+
+#include "Util/CRC.h"
+
+#include <algorithm>
+#include <cstring>
+
+void DryRunOutput::write(int64_t position, const void* data, size_t length)
+{
+	const uint8_t* bytes = (const uint8_t*) data;
+
+	// most writes continue the previous one
+	if (!patches.empty())
+	{
+		Patch& last = patches.back();
+		if (last.position+(int64_t)last.data.size() == position)
+		{
+			last.data.insert(last.data.end(),bytes,bytes+length);
+			return;
+		}
+	}
+
+	patches.push_back({ position, std::vector<uint8_t>(bytes,bytes+length) });
+}
+
+int64_t DryRunOutput::getBaseSize() const
+{
+	if (baseName.empty())
+		return 0;
+
+	std::error_code error;
+	int64_t baseSize = (int64_t) fs::file_size(baseName,error);
+	return error ? 0 : baseSize;
+}
+
+void DryRunOutput::readContent(int64_t baseSize, int64_t size, const std::function<void(uint8_t*,size_t)>& callback) const
+{
+	// the base file with all writes applied in order. the area past the
+	// end of the base file is zero, like in a real file
+	fs::ifstream stream;
+	if (baseSize != 0)
+		stream.open(baseName, fs::ifstream::in | fs::ifstream::binary);
+
+	// assign each patch to the chunks it overlaps once, in write order, so
+	// every chunk only applies the patches that touch it
+	const int64_t chunkSize = 65536;
+	std::vector<std::vector<size_t>> chunkPatches((size_t) ((size+chunkSize-1)/chunkSize));
+	for (size_t i = 0; i < patches.size(); i++)
+	{
+		int64_t start = std::max<int64_t>(0,patches[i].position);
+		int64_t end = std::min(size,patches[i].position+(int64_t)patches[i].data.size());
+		for (int64_t chunk = start/chunkSize; chunk*chunkSize < end; chunk++)
+			chunkPatches[(size_t) chunk].push_back(i);
+	}
+
+	std::vector<uint8_t> buffer(chunkSize);
+	for (int64_t chunkStart = 0; chunkStart < size; chunkStart += chunkSize)
+	{
+		int64_t chunkEnd = std::min(chunkStart+chunkSize,size);
+		size_t length = (size_t) (chunkEnd-chunkStart);
+
+		size_t baseLength = 0;
+		if (chunkStart < baseSize && stream.is_open())
+		{
+			stream.read((char*) buffer.data(),(std::streamsize) std::min<int64_t>(chunkEnd,baseSize)-chunkStart);
+			baseLength = (size_t) stream.gcount();
+		}
+		memset(buffer.data()+baseLength,0,length-baseLength);
+
+		for (size_t index: chunkPatches[(size_t) (chunkStart/chunkSize)])
+		{
+			const Patch& patch = patches[index];
+			int64_t start = std::max(chunkStart,patch.position);
+			int64_t end = std::min(chunkEnd,patch.position+(int64_t)patch.data.size());
+			memcpy(buffer.data()+(start-chunkStart),patch.data.data()+(start-patch.position),(size_t)(end-start));
+		}
+
+		callback(buffer.data(),length);
+	}
+}
+
+DryRunSummary DryRunOutput::summarize(const fs::path& fileName) const
+{
+	DryRunSummary summary;
+	summary.fileName = fileName;
+	summary.crc32 = 0;
+
+	int64_t baseSize = getBaseSize();
+	summary.size = baseSize;
+	for (const Patch& patch: patches)
+	{
+		int64_t end = patch.position+(int64_t)patch.data.size();
+		summary.size = std::max(summary.size,end);
+		summary.modifiedRanges.emplace_back(patch.position,end);
+	}
+
+	// merge the written ranges
+	std::sort(summary.modifiedRanges.begin(),summary.modifiedRanges.end());
+	std::vector<std::pair<int64_t,int64_t>> merged;
+	for (const auto& range: summary.modifiedRanges)
+	{
+		if (range.first == range.second)
+			continue;
+
+		if (!merged.empty() && range.first <= merged.back().second)
+			merged.back().second = std::max(merged.back().second,range.second);
+		else
+			merged.push_back(range);
+	}
+	summary.modifiedRanges = std::move(merged);
+
+	readContent(baseSize,summary.size,[&](uint8_t* data, size_t length)
+	{
+		summary.crc32 = getCrc32(data,length,summary.crc32);
+	});
+
+	return summary;
+}
+
+ByteArray DryRunOutput::getContent() const
+{
+	int64_t baseSize = getBaseSize();
+	int64_t size = baseSize;
+	for (const Patch& patch: patches)
+		size = std::max(size,patch.position+(int64_t)patch.data.size());
+
+	ByteArray content;
+	readContent(baseSize,size,[&](uint8_t* data, size_t length)
+	{
+		content.append(data,length);
+	});
+
+	return content;
+}
+
+DryRunOutput& DryRunOutputs::open(const fs::path& fileName, const fs::path& baseName)
+{
+	DryRunOutput output;
+	output.baseName = baseName;
+
+	auto it = outputs.find(baseName);
+	if (!baseName.empty() && it != outputs.end())
+		output = it->second;
+
+	DryRunOutput& result = outputs[fileName];
+	result = std::move(output);
+	return result;
+}
+
+std::vector<DryRunSummary> DryRunOutputs::summarize() const
+{
+	std::vector<DryRunSummary> result;
+	for (const auto& it: outputs)
+		result.push_back(it.second.summarize(it.first));
+	return result;
+}
+
+std::map<fs::path,ByteArray> DryRunOutputs::getContents() const
+{
+	std::map<fs::path,ByteArray> result;
+	for (const auto& it: outputs)
+		result.emplace(it.first,it.second.getContent());
+	return result;
+}
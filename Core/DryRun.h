@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Util/ByteArray.h"
+#include "Util/FileSystem.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+struct DryRunSummary
+{
+	fs::path fileName;
+	int64_t size;
+	uint32_t crc32;
+	std::vector<std::pair<int64_t,int64_t>> modifiedRanges;
+};
+
+// Collects the writes to one output file instead of writing them. The
+// content of the output is only computed for the summary by overlaying the
+// writes on the file it was based on.
+class DryRunOutput
+{
+public:
+	void write(int64_t position, const void* data, size_t length);
+	DryRunSummary summarize(const fs::path& fileName) const;
+	ByteArray getContent() const;
+private:
+	friend class DryRunOutputs;
+
+	int64_t getBaseSize() const;
+	// passes the content in order, in chunks of limited size
+	void readContent(int64_t baseSize, int64_t size, const std::function<void(uint8_t*,size_t)>& callback) const;
+
+	struct Patch
+	{
+		int64_t position;
+		std::vector<uint8_t> data;
+	};
+
+	fs::path baseName;
+	std::vector<Patch> patches;
+};
+
+class DryRunOutputs
+{
+public:
+	// starts an output based on baseName, or an empty file if it's empty.
+	// outputs of the same run are used instead of the files on disk
+	DryRunOutput& open(const fs::path& fileName, const fs::path& baseName);
+	std::vector<DryRunSummary> summarize() const;
+	std::map<fs::path,ByteArray> getContents() const;
+	void clear() { outputs.clear(); }
+private:
+	std::map<fs::path,DryRunOutput> outputs;
+};
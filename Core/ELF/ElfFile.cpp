@@ -78,8 +78,10 @@ ElfSegment::ElfSegment(Elf32_Phdr header, ByteArray& segmentData): header(header
 	paddrSection = nullptr;
 }
 
-bool ElfSegment::isSectionPartOf(ElfSection* section)
+bool ElfSegment::isSectionPartOf(ElfSection* section, bool& partial)
 {
+	partial = false;
+
 	int sectionStart = section->getOffset();
 	int sectionSize = section->getType() == SHT_NOBITS ? 0 : section->getSize();
 	int sectionEnd = sectionStart+sectionSize;
@@ -96,7 +98,7 @@ bool ElfSegment::isSectionPartOf(ElfSection* section)
 	// the start is inside the section and the size is not 0, so the end should be in here too
 	if (sectionEnd > segmentEnd)
 	{
-		Logger::printError(Logger::Error,L"Section partially contained in segment");
+		partial = true;
 		return false;
 	}
 
@@ -360,6 +362,7 @@ bool ElfFile::load(const fs::path& fileName, bool sort)
 bool ElfFile::load(ByteArray& data, bool sort)
 {
 	fileData = data;
+	errors.clear();
 
 	loadElfHeader();
 	symTab = nullptr;
@@ -393,11 +396,15 @@ bool ElfFile::load(ByteArray& data, bool sort)
 		ElfSegment* owner = nullptr;
 		for (int k = 0; k < (int)segments.size(); k++)
 		{
-			if (segments[k]->isSectionPartOf(section))
+			bool partial;
+			if (segments[k]->isSectionPartOf(section,partial))
 			{
 				owner = segments[k];
 				break;
 			}
+
+			if (partial)
+				errors.push_back(L"Section partially contained in segment");
 		}
 
 		if (owner != nullptr)
@@ -444,6 +451,12 @@ bool ElfFile::load(ByteArray& data, bool sort)
 }
 
 void ElfFile::save(const fs::path& fileName)
+{
+	buildFileData();
+	fileData.toFile(fileName);
+}
+
+void ElfFile::buildFileData()
 {
 	fileData.clear();
 
@@ -493,8 +506,6 @@ void ElfFile::save(const fs::path& fileName)
 		size_t pos = fileHeader.e_shoff+i*fileHeader.e_shentsize;
 		sections[i]->writeHeader(fileData, pos, endianness);
 	}
-
-	fileData.toFile(fileName);
 }
 
 int ElfFile::getSymbolCount()
@@ -3,6 +3,7 @@
 #include "Core/ELF/ElfTypes.h"
 #include "Util/ByteArray.h"
 
+#include <string>
 #include <vector>
 
 enum ElfPart { ELFPART_SEGMENTTABLE, ELFPART_SECTIONTABLE, ELFPART_SEGMENTS, ELFPART_SEGMENTLESSSECTIONS };
@@ -17,6 +18,7 @@ public:
 	bool load(const fs::path&fileName, bool sort);
 	bool load(ByteArray& data, bool sort);
 	void save(const fs::path& fileName);
+	void buildFileData();
 
 	Elf32_Half getType() { return fileHeader.e_type; };
 	Elf32_Half getMachine() { return fileHeader.e_machine; };
@@ -35,6 +37,9 @@ public:
 	int getSymbolCount();
 	bool getSymbol(Elf32_Sym& symbol, size_t index);
 	const char* getStrTableString(size_t pos);
+	// errors of the last load, reported by the caller as files can be
+	// loaded on any thread
+	const std::vector<std::wstring>& getErrors() const { return errors; }
 private:
 	void loadElfHeader();
 	void writeHeader(ByteArray& data, size_t pos, Endianness endianness);
@@ -52,6 +57,7 @@ private:
 
 	ElfSection* symTab;
 	ElfSection* strTab;
+	std::vector<std::wstring> errors;
 };
 
 
@@ -88,7 +94,7 @@ class ElfSegment
 {
 public:
 	ElfSegment(Elf32_Phdr header, ByteArray& segmentData);
-	bool isSectionPartOf(ElfSection* section);
+	bool isSectionPartOf(ElfSection* section, bool& partial);
 	void addSection(ElfSection* section);
 	Elf32_Off getOffset() { return header.p_offset; };
 	Elf32_Word getPhysSize() { return header.p_filesz; };
@@ -7,9 +7,11 @@
 #include "Core/SymbolData.h"
 #include "Util/CRC.h"
 #include "Util/FileSystem.h"
+#include "Util/ThreadPool.h"
 #include "Util/Util.h"
 
 #include <cstring>
+#include <memory>
 
 struct ArFileHeader
 {
@@ -105,6 +107,7 @@ bool ElfRelocator::init(const fs::path& inputName)
 		return false;
 	}
 
+	Global.dependencies.addInput(fs::absolute(inputName).lexically_normal());
 	auto inputFiles = loadArArchive(inputName);
 	if (inputFiles.size() == 0)
 	{
@@ -112,12 +115,28 @@ bool ElfRelocator::init(const fs::path& inputName)
 		return false;
 	}
 
-	for (ArFileEntry& entry: inputFiles)
+	// parsing the object files is independent of each other, only the
+	// checks and symbol setup below have to run in order
+	// files are only released once they are owned by an ElfRelocatorFile
+	std::vector<std::unique_ptr<ElfFile>> elfFiles(inputFiles.size());
+	std::vector<char> elfLoaded(inputFiles.size());
+	Global.threadPool->parallelFor(inputFiles.size(), [&](size_t index)
 	{
+		elfFiles[index] = std::make_unique<ElfFile>();
+		elfLoaded[index] = elfFiles[index]->load(inputFiles[index].data,false);
+	});
+
+	for (size_t index = 0; index < inputFiles.size(); index++)
+	{
+		ArFileEntry& entry = inputFiles[index];
 		ElfRelocatorFile file;
 
-		ElfFile* elf = new ElfFile();
-		if (!elf->load(entry.data,false))
+		// loading ran on the pool, errors are reported here in input order
+		ElfFile* elf = elfFiles[index].get();
+		for (const std::wstring& error: elf->getErrors())
+			Logger::printError(Logger::Error,L"%s",error);
+
+		if (!elfLoaded[index])
 		{
 			Logger::printError(Logger::Error,L"Could not load object file %s",entry.name);
 			return false;
@@ -214,7 +233,7 @@ bool ElfRelocator::init(const fs::path& inputName)
 			}
 		}
 
-		file.elf = elf;
+		file.elf = elfFiles[index].release();
 		file.name = entry.name;
 		files.push_back(file);
 	}
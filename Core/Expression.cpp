@@ -5,8 +5,13 @@
 #include "Core/ExpressionFunctions.h"
 #include "Core/FileManager.h"
 #include "Core/Misc.h"
+#include "Util/Profiler.h"
 #include "Util/Util.h"
 
+#include <mutex>
+#include <type_traits>
+#include <unordered_set>
+
 namespace
 {
 	std::wstring to_wstring(int64_t value)
@@ -38,6 +43,24 @@ ExpressionValueCombination getValueCombination(ExpressionValueType a, Expression
 	return (ExpressionValueCombination) ((int(a) << 2) | (int(b) << 0));
 }
 
+static_assert(std::is_trivially_copyable<ExpressionValue>::value, "ExpressionValue has to stay trivially copyable");
+
+// evaluation may run on several threads during encoding
+static std::mutex storedStringsMutex;
+static std::unordered_set<std::wstring> storedStrings;
+
+const std::wstring* ExpressionValue::storeString(std::wstring value)
+{
+	std::lock_guard<std::mutex> lock(storedStringsMutex);
+	return &*storedStrings.insert(std::move(value)).first;
+}
+
+void ExpressionValue::clearStrings()
+{
+	std::lock_guard<std::mutex> lock(storedStringsMutex);
+	storedStrings.clear();
+}
+
 ExpressionValue ExpressionValue::operator+(const ExpressionValue& other) const
 {
 	ExpressionValue result;
@@ -60,24 +83,19 @@ ExpressionValue ExpressionValue::operator+(const ExpressionValue& other) const
 		result.floatValue = floatValue + other.floatValue;
 		break;
 	case ExpressionValueCombination::IS:
-		result.type = ExpressionValueType::String;
-		result.strValue = to_wstring(intValue) + other.strValue;
+		result = ExpressionValue(to_wstring(intValue) + *other.strValue);
 		break;
 	case ExpressionValueCombination::FS:
-		result.type = ExpressionValueType::String;
-		result.strValue = to_wstring(floatValue) + other.strValue;
+		result = ExpressionValue(to_wstring(floatValue) + *other.strValue);
 		break;
 	case ExpressionValueCombination::SI:
-		result.type = ExpressionValueType::String;
-		result.strValue = strValue + to_wstring(other.intValue);
+		result = ExpressionValue(*strValue + to_wstring(other.intValue));
 		break;
 	case ExpressionValueCombination::SF:
-		result.type = ExpressionValueType::String;
-		result.strValue = strValue + to_wstring(other.floatValue);
+		result = ExpressionValue(*strValue + to_wstring(other.floatValue));
 		break;
 	case ExpressionValueCombination::SS:
-		result.type = ExpressionValueType::String;
-		result.strValue = strValue + other.strValue;
+		result = ExpressionValue(*strValue + *other.strValue);
 		break;
 	}
 
@@ -277,7 +295,7 @@ bool ExpressionValue::operator<(const ExpressionValue& other) const
 	case ExpressionValueCombination::FF:
 		return floatValue < other.floatValue;
 	case ExpressionValueCombination::SS:
-		return strValue < other.strValue;
+		return *strValue < *other.strValue;
 	default:
 		break;
 	}
@@ -298,7 +316,7 @@ bool ExpressionValue::operator<=(const ExpressionValue& other) const
 	case ExpressionValueCombination::FF:
 		return floatValue <= other.floatValue;
 	case ExpressionValueCombination::SS:
-		return strValue <= other.strValue;
+		return *strValue <= *other.strValue;
 	default:
 		break;
 	}
@@ -329,15 +347,15 @@ bool ExpressionValue::operator==(const ExpressionValue& other) const
 	case ExpressionValueCombination::FF:
 		return floatValue == other.floatValue;
 	case ExpressionValueCombination::IS:
-		return to_wstring(intValue) == other.strValue;
+		return to_wstring(intValue) == *other.strValue;
 	case ExpressionValueCombination::FS:
-		return to_wstring(floatValue) == other.strValue;
+		return to_wstring(floatValue) == *other.strValue;
 	case ExpressionValueCombination::SI:
-		return strValue == to_wstring(other.intValue);
+		return *strValue == to_wstring(other.intValue);
 	case ExpressionValueCombination::SF:
-		return strValue == to_wstring(other.floatValue);
+		return *strValue == to_wstring(other.floatValue);
 	case ExpressionValueCombination::SS:
-		return strValue == other.strValue;
+		return *strValue == *other.strValue;
 	}
 
 	return false;
@@ -452,6 +470,9 @@ ExpressionInternal::ExpressionInternal()
 {
 	children = nullptr;
 	childrenCount = 0;
+	functionEntry = nullptr;
+	labelFunctionEntry = nullptr;
+	functionArch = nullptr;
 }
 
 ExpressionInternal::~ExpressionInternal()
@@ -482,8 +503,8 @@ ExpressionInternal::ExpressionInternal(const std::wstring& value, OperatorType t
 	switch (type)
 	{
 	case OperatorType::Identifier:
-		fileNum = Global.FileInfo.FileNum;
 		section = Global.Section;
+		symbolKey = SymbolKey(value,Global.FileInfo.FileNum,section);
 		break;
 	case OperatorType::String:
 		break;
@@ -515,6 +536,8 @@ ExpressionInternal::ExpressionInternal(const std::wstring& name, const std::vect
 	{
 		children[i] = parameters[i];
 	}
+
+	bindFunctionCall();
 }
 
 void ExpressionInternal::allocate(size_t count)
@@ -551,8 +574,8 @@ void ExpressionInternal::replaceMemoryPos(const std::wstring& identifierName)
 	{
 		type = OperatorType::Identifier;
 		strValue = identifierName;
-		fileNum = Global.FileInfo.FileNum;
 		section = Global.Section;
+		symbolKey = SymbolKey(identifierName,Global.FileInfo.FileNum,section);
 	}
 }
 
@@ -579,24 +602,30 @@ ExpressionValue ExpressionInternal::executeExpressionFunctionCall(const Expressi
 	if (!checkParameterCount(entry.minParams, entry.maxParams))
 		return {};
 
-	// evaluate parameters
-	std::vector<ExpressionValue> params;
-	params.reserve(childrenCount);
+	// evaluate parameters. only variadic functions can exceed the buffer
+	const size_t bufferSize = 8;
+	ExpressionValue buffer[bufferSize];
+	std::vector<ExpressionValue> overflow;
+
+	ExpressionValue* params = buffer;
+	if (childrenCount > bufferSize)
+	{
+		overflow.resize(childrenCount);
+		params = overflow.data();
+	}
 
 	for (size_t i = 0; i < childrenCount; i++)
 	{
-		ExpressionValue result = children[i]->evaluate();
-		if (!result.isValid())
+		params[i] = children[i]->evaluate();
+		if (!params[i].isValid())
 		{
 			Logger::queueError(Logger::Error,L"%s: Invalid parameter %d", strValue, i+1);
-			return result;
+			return params[i];
 		}
-
-		params.push_back(result);
 	}
 
 	// execute
-	return entry.function(strValue, params);
+	return entry.function(strValue, ExpressionFunctionParameters(params,childrenCount));
 }
 
 ExpressionValue ExpressionInternal::executeExpressionLabelFunctionCall(const ExpressionLabelFunctionEntry& entry)
@@ -618,8 +647,7 @@ ExpressionValue ExpressionInternal::executeExpressionLabelFunctionCall(const Exp
 			return {};
 		}
 
-		const std::wstring& name = exp->getStringValue();
-		std::shared_ptr<Label> label = Global.symbolTable.getLabel(name,exp->getFileNum(),exp->getSection());
+		std::shared_ptr<Label> label = Global.symbolTable.getLabel(exp->getSymbolKey(),exp->getSection());
 		params.push_back(label);
 	}
 
@@ -627,27 +655,58 @@ ExpressionValue ExpressionInternal::executeExpressionLabelFunctionCall(const Exp
 	return entry.function(strValue, params);
 }
 
-ExpressionValue ExpressionInternal::executeFunctionCall()
+bool ExpressionInternal::bindFunctionCall()
 {
+	if (functionArch != nullptr && functionArch != Arch)
+	{
+		functionEntry = nullptr;
+		functionArch = nullptr;
+	}
+
+	if (functionEntry != nullptr || labelFunctionEntry != nullptr)
+		return true;
+
 	// try expression functions
 	auto expFuncIt = expressionFunctions.find(strValue);
 	if (expFuncIt != expressionFunctions.end())
-		return executeExpressionFunctionCall(expFuncIt->second);
+	{
+		functionEntry = &expFuncIt->second;
+		return true;
+	}
 
 	// try expression label functions
 	auto expLabelFuncIt = expressionLabelFunctions.find(strValue);
 	if (expLabelFuncIt != expressionLabelFunctions.end())
-		return executeExpressionLabelFunctionCall(expLabelFuncIt->second);
+	{
+		labelFunctionEntry = &expLabelFuncIt->second;
+		return true;
+	}
 
 	// try architecture specific expression functions
 	auto& archExpressionFunctions = Arch->getExpressionFunctions();
 	expFuncIt = archExpressionFunctions.find(strValue);
 	if (expFuncIt != archExpressionFunctions.end())
-		return executeExpressionFunctionCall(expFuncIt->second);
+	{
+		functionEntry = &expFuncIt->second;
+		functionArch = Arch;
+		return true;
+	}
+
+	return false;
+}
 
-	// error
-	Logger::queueError(Logger::Error, L"Unknown function \"%s\"", strValue);
-	return {};
+ExpressionValue ExpressionInternal::executeFunctionCall()
+{
+	if (!bindFunctionCall())
+	{
+		Logger::queueError(Logger::Error, L"Unknown function \"%s\"", strValue);
+		return {};
+	}
+
+	if (labelFunctionEntry != nullptr)
+		return executeExpressionLabelFunctionCall(*labelFunctionEntry);
+
+	return executeExpressionFunctionCall(*functionEntry);
 }
 
 bool isExpressionFunctionSafe(const std::wstring& name, bool inUnknownOrFalseBlock)
@@ -733,7 +792,7 @@ bool ExpressionInternal::simplify(bool inUnknownOrFalseBlock)
 			break;
 		case ExpressionValueType::String:
 			type = OperatorType::String;
-			strValue = value.strValue;
+			strValue = *value.strValue;
 			break;
 		default:
 			type = OperatorType::Invalid;
@@ -762,7 +821,7 @@ ExpressionValue ExpressionInternal::evaluate()
 		val.floatValue = floatValue;
 		return val;
 	case OperatorType::Identifier:
-		label = Global.symbolTable.getLabel(strValue,fileNum,section);
+		label = Global.symbolTable.getLabel(symbolKey,section);
 		if (label == nullptr)
 		{
 			Logger::queueError(Logger::Error,L"Invalid label name \"%s\"",strValue);
@@ -779,17 +838,13 @@ ExpressionValue ExpressionInternal::evaluate()
 		val.intValue = label->getValue();
 		return val;
 	case OperatorType::String:
-		val.type = ExpressionValueType::String;
-		val.strValue = strValue;
-		return val;
+		return ExpressionValue(&strValue);
 	case OperatorType::MemoryPos:
 		val.type = ExpressionValueType::Integer;
 		val.intValue = g_fileManager->getVirtualAddress();
 		return val;
 	case OperatorType::ToString:
-		val.type = ExpressionValueType::String;
-		val.strValue = children[0]->toString();
-		return val;
+		return ExpressionValue(children[0]->toString());
 	case OperatorType::Add:
 		return children[0]->evaluate() + children[1]->evaluate();
 	case OperatorType::Sub:
@@ -973,6 +1028,7 @@ ExpressionValue Expression::evaluate()
 		return invalid;
 	}
 
+	Profiler::countEvaluation();
 	return expression->evaluate();
 }
 
@@ -987,6 +1043,7 @@ bool Expression::evaluateString(std::wstring &dest, bool convert)
 	if (expression == nullptr)
 		return false;
 
+	Profiler::countEvaluation();
 	ExpressionValue value = expression->evaluate();
 	if (convert && value.isInt())
 	{
@@ -1003,7 +1060,7 @@ bool Expression::evaluateString(std::wstring &dest, bool convert)
 	if (!value.isString())
 		return false;
 
-	dest = value.strValue;
+	dest = *value.strValue;
 	return true;
 }
 
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "Core/SymbolTable.h"
+#include "Util/MemoryStats.h"
+
 #include <memory>
 #include <string>
 #include <vector>
 
+class CArchitecture;
 class Label;
 
 struct ExpressionFunctionEntry;
@@ -67,12 +71,19 @@ struct ExpressionValue
 		floatValue = value;
 	}
 
-	ExpressionValue(const std::wstring& value)
+	// the string has to outlive the value, e.g. the text of an expression
+	ExpressionValue(const std::wstring* value)
 	{
 		type = ExpressionValueType::String;
 		strValue = value;
 	}
 
+	ExpressionValue(std::wstring value)
+	{
+		type = ExpressionValueType::String;
+		strValue = storeString(std::move(value));
+	}
+
 	bool isFloat() const
 	{
 		return type == ExpressionValueType::Float;
@@ -97,10 +108,14 @@ struct ExpressionValue
 	{
 		int64_t intValue;
 		double floatValue;
+		const std::wstring* strValue;
 	};
 
-	std::wstring strValue;
-	
+	// computed strings are kept until the next run, so values can be copied
+	// freely. equal strings are only stored once
+	static const std::wstring* storeString(std::wstring value);
+	static void clearStrings();
+
 	ExpressionValue operator!() const;
 	ExpressionValue operator~() const;
 	bool operator<(const ExpressionValue& other) const;
@@ -123,7 +138,7 @@ struct ExpressionValue
 	ExpressionValue operator^(const ExpressionValue& other) const;
 };
 
-class ExpressionInternal
+class ExpressionInternal: public MemoryTrackedHeap<MemoryCategory::Expressions>
 {
 public:
 	ExpressionInternal();
@@ -140,8 +155,8 @@ public:
 	std::wstring getStringValue() { return strValue; }
 	void replaceMemoryPos(const std::wstring& identifierName);
 	bool simplify(bool inUnknownOrFalseBlock);
-	unsigned int getFileNum() { return fileNum; }
-	unsigned int getSection() { return section; }
+	const SymbolKey& getSymbolKey() { return symbolKey; }
+	int getSection() { return section; }
 private:
 	void allocate(size_t count);
 	void deallocate();
@@ -149,6 +164,7 @@ private:
 	ExpressionValue executeExpressionFunctionCall(const ExpressionFunctionEntry& entry);
 	ExpressionValue executeExpressionLabelFunctionCall(const ExpressionLabelFunctionEntry& entry);
 	ExpressionValue executeFunctionCall();
+	bool bindFunctionCall();
 	bool checkParameterCount(size_t min, size_t max);
 
 	OperatorType type;
@@ -162,7 +178,15 @@ private:
 	};
 	std::wstring strValue;
 
-	unsigned int fileNum, section;
+	// scope of an identifier, resolved when the expression is created
+	SymbolKey symbolKey;
+	int section;
+
+	// callee of a function call. functionArch is set when the function
+	// belongs to an architecture, it has to be looked up again after a switch
+	const ExpressionFunctionEntry* functionEntry;
+	const ExpressionLabelFunctionEntry* labelFunctionEntry;
+	const CArchitecture* functionArch;
 };
 
 class Expression
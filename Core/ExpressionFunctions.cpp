@@ -28,7 +28,7 @@
 #define ARMIPS_EXCEPTIONS 0
 #endif
 
-bool getExpFuncParameter(const std::vector<ExpressionValue>& parameters, size_t index, int64_t& dest,
+bool getExpFuncParameter(const ExpressionFunctionParameters& parameters, size_t index, int64_t& dest,
 	const std::wstring& funcName, bool optional)
 {
 	if (optional && index >= parameters.size())
@@ -44,7 +44,7 @@ bool getExpFuncParameter(const std::vector<ExpressionValue>& parameters, size_t
 	return true;
 }
 
-bool getExpFuncParameter(const std::vector<ExpressionValue>& parameters, size_t index, const std::wstring*& dest,
+bool getExpFuncParameter(const ExpressionFunctionParameters& parameters, size_t index, const std::wstring*& dest,
 	const std::wstring& funcName, bool optional)
 {
 	if (optional && index >= parameters.size())
@@ -56,7 +56,7 @@ bool getExpFuncParameter(const std::vector<ExpressionValue>& parameters, size_t
 		return false;
 	}
 
-	dest = &parameters[index].strValue;
+	dest = parameters[index].strValue;
 	return true;
 }
 
@@ -69,13 +69,13 @@ bool getExpFuncParameter(const std::vector<ExpressionValue>& parameters, size_t
 		return ExpressionValue();
 
 
-ExpressionValue expFuncVersion(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncVersion(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	int64_t value = ARMIPS_VERSION_MAJOR*1000 + ARMIPS_VERSION_MINOR*10 + ARMIPS_VERSION_REVISION;
 	return ExpressionValue(value);
 }
 
-ExpressionValue expFuncEndianness(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncEndianness(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	ExpressionValue result;
 	result.type = ExpressionValueType::String;
@@ -91,7 +91,7 @@ ExpressionValue expFuncEndianness(const std::wstring& funcName, const std::vecto
 	return ExpressionValue();
 }
 
-ExpressionValue expFuncOutputName(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncOutputName(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	std::shared_ptr<AssemblerFile> file = g_fileManager->getOpenFile();
 	if (file == nullptr)
@@ -104,50 +104,44 @@ ExpressionValue expFuncOutputName(const std::wstring& funcName, const std::vecto
 	return ExpressionValue(value);
 }
 
-ExpressionValue expFuncFileExists(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncFileExists(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	const std::wstring* fileName;
 	GET_PARAM(parameters,0,fileName);
 
 	auto fullName = getFullPathName(*fileName);
+	Global.dependencies.addInput(fullName);
 	return ExpressionValue(fs::exists(fullName) ? INT64_C(1) : INT64_C(0));
 }
 
-ExpressionValue expFuncFileSize(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncFileSize(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	const std::wstring* fileName;
 	GET_PARAM(parameters,0,fileName);
 
 	auto fullName = getFullPathName(*fileName);
+	Global.dependencies.addInput(fullName);
 
 	std::error_code error;
 	return ExpressionValue(static_cast<int64_t>(fs::file_size(fullName, error)));
 }
 
-ExpressionValue expFuncToString(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncToString(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
-	ExpressionValue result;
-
 	switch (parameters[0].type)
 	{
 	case ExpressionValueType::String:
-		result.strValue = parameters[0].strValue;
-		break;
+		return parameters[0];
 	case ExpressionValueType::Integer:
-		result.strValue = tfm::format(L"%d",parameters[0].intValue);
-		break;
+		return ExpressionValue(tfm::format(L"%d",parameters[0].intValue));
 	case ExpressionValueType::Float:
-		result.strValue = tfm::format(L"%#.17g",parameters[0].floatValue);
-		break;
+		return ExpressionValue(tfm::format(L"%#.17g",parameters[0].floatValue));
 	default:
-		return result;
+		return ExpressionValue();
 	}
-
-	result.type = ExpressionValueType::String;
-	return result;
 }
 
-ExpressionValue expFuncToHex(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncToHex(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	int64_t value, digits;
 	GET_PARAM(parameters,0,value);
@@ -156,7 +150,7 @@ ExpressionValue expFuncToHex(const std::wstring& funcName, const std::vector<Exp
 	return ExpressionValue(tfm::format(L"%0*X",digits,value));
 }
 
-ExpressionValue expFuncInt(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncInt(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	ExpressionValue result;
 
@@ -176,7 +170,7 @@ ExpressionValue expFuncInt(const std::wstring& funcName, const std::vector<Expre
 	return result;
 }
 
-ExpressionValue expFuncRound(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncRound(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	ExpressionValue result;
 
@@ -196,7 +190,7 @@ ExpressionValue expFuncRound(const std::wstring& funcName, const std::vector<Exp
 	return result;
 }
 
-ExpressionValue expFuncFloat(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncFloat(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	ExpressionValue result;
 
@@ -216,7 +210,7 @@ ExpressionValue expFuncFloat(const std::wstring& funcName, const std::vector<Exp
 	return result;
 }
 
-ExpressionValue expFuncFrac(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncFrac(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	ExpressionValue result;
 	double intPart;
@@ -234,7 +228,7 @@ ExpressionValue expFuncFrac(const std::wstring& funcName, const std::vector<Expr
 	return result;
 }
 
-ExpressionValue expFuncMin(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncMin(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	ExpressionValue result;
 	double floatMin, floatCur;
@@ -280,7 +274,7 @@ ExpressionValue expFuncMin(const std::wstring& funcName, const std::vector<Expre
 	return result;
 }
 
-ExpressionValue expFuncMax(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncMax(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	ExpressionValue result;
 	double floatMax, floatCur;
@@ -326,7 +320,7 @@ ExpressionValue expFuncMax(const std::wstring& funcName, const std::vector<Expre
 	return result;
 }
 
-ExpressionValue expFuncAbs(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncAbs(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	ExpressionValue result;
 
@@ -348,7 +342,7 @@ ExpressionValue expFuncAbs(const std::wstring& funcName, const std::vector<Expre
 	return result;
 }
 
-ExpressionValue expFuncStrlen(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncStrlen(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	const std::wstring* source;
 	GET_PARAM(parameters,0,source);
@@ -356,7 +350,7 @@ ExpressionValue expFuncStrlen(const std::wstring& funcName, const std::vector<Ex
 	return ExpressionValue((int64_t)source->size());
 }
 
-ExpressionValue expFuncSubstr(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncSubstr(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	int64_t start, count;
 	const std::wstring* source;
@@ -369,7 +363,7 @@ ExpressionValue expFuncSubstr(const std::wstring& funcName, const std::vector<Ex
 }
 
 #if ARMIPS_REGEXP
-ExpressionValue expFuncRegExMatch(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncRegExMatch(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	const std::wstring* source;
 	const std::wstring* regexString;
@@ -393,7 +387,7 @@ ExpressionValue expFuncRegExMatch(const std::wstring& funcName, const std::vecto
 #endif
 }
 
-ExpressionValue expFuncRegExSearch(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncRegExSearch(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	const std::wstring* source;
 	const std::wstring* regexString;
@@ -417,7 +411,7 @@ ExpressionValue expFuncRegExSearch(const std::wstring& funcName, const std::vect
 #endif
 }
 
-ExpressionValue expFuncRegExExtract(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncRegExExtract(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	const std::wstring* source;
 	const std::wstring* regexString;
@@ -451,7 +445,7 @@ ExpressionValue expFuncRegExExtract(const std::wstring& funcName, const std::vec
 }
 #endif
 
-ExpressionValue expFuncFind(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncFind(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	int64_t start;
 	const std::wstring* source;
@@ -465,7 +459,7 @@ ExpressionValue expFuncFind(const std::wstring& funcName, const std::vector<Expr
 	return ExpressionValue(pos == std::wstring::npos ? INT64_C(-1) : (int64_t) pos);
 }
 
-ExpressionValue expFuncRFind(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncRFind(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	int64_t start;
 	const std::wstring* source;
@@ -481,7 +475,7 @@ ExpressionValue expFuncRFind(const std::wstring& funcName, const std::vector<Exp
 
 
 template<typename T>
-ExpressionValue expFuncRead(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncRead(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	const std::wstring* fileName;
 	int64_t pos;
@@ -490,6 +484,7 @@ ExpressionValue expFuncRead(const std::wstring& funcName, const std::vector<Expr
 	GET_OPTIONAL_PARAM(parameters,1,pos,0);
 
 	auto fullName = getFullPathName(*fileName);
+	Global.dependencies.addInput(fullName);
 
 	fs::ifstream file(fullName, fs::ifstream::in | fs::ifstream::binary);
 	if (!file.is_open())
@@ -517,7 +512,7 @@ ExpressionValue expFuncRead(const std::wstring& funcName, const std::vector<Expr
 	return ExpressionValue((int64_t) buffer);
 }
 
-ExpressionValue expFuncReadAscii(const std::wstring& funcName, const std::vector<ExpressionValue>& parameters)
+ExpressionValue expFuncReadAscii(const std::wstring& funcName, const ExpressionFunctionParameters& parameters)
 {
 	const std::wstring* fileName;
 	int64_t start;
@@ -528,6 +523,7 @@ ExpressionValue expFuncReadAscii(const std::wstring& funcName, const std::vector
 	GET_OPTIONAL_PARAM(parameters,2,length,0);
 
 	auto fullName = getFullPathName(*fileName);
+	Global.dependencies.addInput(fullName);
 
 	std::error_code error;
 	int64_t totalSize = static_cast<int64_t>(fs::file_size(fullName, error));
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Core/Expression.h"
+
 #include <map>
 #include <memory>
 #include <string>
@@ -7,15 +9,32 @@
 
 class Label;
 
-struct ExpressionValue;
+// evaluated parameters of an expression function call, usually stored in a
+// fixed size buffer on the caller's stack
+class ExpressionFunctionParameters
+{
+public:
+	ExpressionFunctionParameters(const ExpressionValue* values, size_t count)
+		: values(values), count(count) { }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	const ExpressionValue& operator[](size_t index) const { return values[index]; }
+	const ExpressionValue& front() const { return values[0]; }
+	const ExpressionValue* begin() const { return values; }
+	const ExpressionValue* end() const { return values+count; }
+private:
+	const ExpressionValue* values;
+	size_t count;
+};
 
-bool getExpFuncParameter(const std::vector<ExpressionValue>& parameters, size_t index, int64_t& dest,
+bool getExpFuncParameter(const ExpressionFunctionParameters& parameters, size_t index, int64_t& dest,
 	const std::wstring& funcName, bool optional);
 
-bool getExpFuncParameter(const std::vector<ExpressionValue>& parameters, size_t index, const std::wstring*& dest,
+bool getExpFuncParameter(const ExpressionFunctionParameters& parameters, size_t index, const std::wstring*& dest,
 	const std::wstring& funcName, bool optional);
 
-using ExpressionFunction = ExpressionValue (*)(const std::wstring& funcName, const std::vector<ExpressionValue>&);
+using ExpressionFunction = ExpressionValue (*)(const std::wstring& funcName, const ExpressionFunctionParameters&);
 using ExpressionLabelFunction = ExpressionValue (*)(const std::wstring& funcName, const std::vector<std::shared_ptr<Label>> &);
 
 enum class ExpFuncSafety
@@ -3,25 +3,11 @@
 #include "Core/Common.h"
 #include "Core/Misc.h"
 #include "Util/FileSystem.h"
+#include "Util/Profiler.h"
 #include "Util/Util.h"
 
-inline uint64_t swapEndianness64(uint64_t value)
-{
-	return ((value & 0xFF) << 56) | ((value & 0xFF00) << 40) | ((value & 0xFF0000) << 24) | ((value & 0xFF000000) << 8) |
-	((value & 0xFF00000000) >> 8) | ((value & 0xFF0000000000) >> 24) |
-	((value & 0xFF000000000000) >> 40) | ((value & 0xFF00000000000000) >> 56);
-}
-
-inline uint32_t swapEndianness32(uint32_t value)
-{
-	return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) | ((value & 0xFF0000) >> 8) | ((value & 0xFF000000) >> 24);
-}
-
-inline uint16_t swapEndianness16(uint16_t value)
-{
-	return ((value & 0xFF) << 8) | ((value & 0xFF00) >> 8);
-}
-
+#include <algorithm>
+#include <cstring>
 
 GenericAssemblerFile::GenericAssemblerFile(const fs::path& fileName, int64_t headerSize, bool overwrite)
 {
@@ -42,6 +28,19 @@ GenericAssemblerFile::GenericAssemblerFile(const fs::path& fileName, const fs::p
 	mode = Copy;
 }
 
+GenericAssemblerFile::~GenericAssemblerFile()
+{
+	// a file that was never closed is incomplete, it must not replace the output
+	if (stream.is_open())
+	{
+		stream.close();
+
+		std::error_code error;
+		if (writeName != fileName)
+			fs::remove(writeName, error);
+	}
+}
+
 bool GenericAssemblerFile::open(bool onlyCheck)
 {
 	std::error_code errorCode;
@@ -52,8 +51,32 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 	auto flagsOpenExisting = fs::ofstream::in | fs::ofstream::out | fs::ofstream::binary;
 	auto flagsOverwrite = fs::ofstream::out | fs::ofstream::trunc | fs::ofstream::binary;
 
+	if (!onlyCheck && Global.dryRun)
+	{
+		// collect the writes without touching any file
+		switch (mode)
+		{
+		case Open:
+			dryRunOutput = &Global.dryRunOutputs.open(fileName,fileName);
+			break;
+		case Create:
+			dryRunOutput = &Global.dryRunOutputs.open(fileName,fs::path());
+			break;
+		case Copy:
+			dryRunOutput = &Global.dryRunOutputs.open(fileName,originalName);
+			break;
+		}
+		return true;
+	}
+
 	if (!onlyCheck)
 	{
+		// new files are written next to the old one first and only replace
+		// it on close if the content changed
+		writeName = fileName;
+		if (mode != Open && Global.skipUnchangedOutputs)
+			writeName = getTemporaryFileName(fileName);
+
 		// actually open the file
 		switch (mode)
 		{
@@ -67,7 +90,7 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 			return true;
 
 		case Create:
-			stream.open(fileName, flagsOverwrite);
+			stream.open(writeName, flagsOverwrite);
 			if (!stream.is_open())
 			{
 				Logger::printError(Logger::FatalError,L"Could not create file %s",fileName);
@@ -76,13 +99,13 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 			return true;
 
 		case Copy:
-			if (!fs::copy_file(originalName, fileName, fs::copy_options::overwrite_existing, errorCode))
+			if (!fs::copy_file(originalName, writeName, fs::copy_options::overwrite_existing, errorCode))
 			{
 				Logger::printError(Logger::FatalError,L"Could not copy file %s",originalName);
 				return false;
 			}
 
-			stream.open(fileName, flagsOpenExisting);
+			stream.open(writeName, flagsOpenExisting);
 			if (!stream.is_open())
 			{
 				Logger::printError(Logger::FatalError,L"Could not create file %s",fileName);
@@ -92,7 +115,42 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 		}
 	}
 
-	// else only check if it can be done, don't actually do it permanently
+	// else only check if it can be done. the result can't change during
+	// validation, so the file system is only probed once per run
+	probeAccess();
+	if (!accessValid)
+		Logger::queueError(Logger::FatalError,accessError);
+
+	return accessValid;
+}
+
+void GenericAssemblerFile::probeAccess()
+{
+	if (accessChecked)
+		return;
+
+	accessValid = probe();
+	accessChecked = true;
+}
+
+bool GenericAssemblerFile::probe()
+{
+	std::error_code errorCode;
+
+	auto flagsOpenExisting = fs::ofstream::in | fs::ofstream::out | fs::ofstream::binary;
+	auto flagsOverwrite = fs::ofstream::out | fs::ofstream::trunc | fs::ofstream::binary;
+
+	// a dry run only needs to read the files it's based on
+	if (Global.dryRun)
+	{
+		const fs::path& baseName = mode == Copy ? originalName : fileName;
+		if (mode == Create || fs::ifstream(baseName, fs::ifstream::in | fs::ifstream::binary).is_open())
+			return true;
+
+		accessError = tfm::format(L"Could not open file %s",baseName);
+		return false;
+	}
+
 	bool exists = false;
 	fs::ofstream temp;
 	switch (mode)
@@ -101,7 +159,7 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 		temp.open(fileName, flagsOpenExisting);
 		if (!temp.is_open())
 		{
-			Logger::queueError(Logger::FatalError,L"Could not open file %s",fileName);
+			accessError = tfm::format(L"Could not open file %s",fileName);
 			return false;
 		}
 		temp.close();
@@ -114,7 +172,7 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 		temp.open(fileName, exists ? flagsOpenExisting : flagsOverwrite);
 		if (!temp.is_open())
 		{
-			Logger::queueError(Logger::FatalError,L"Could not create file %s",fileName);
+			accessError = tfm::format(L"Could not create file %s",fileName);
 			return false;
 		}
 		temp.close();
@@ -129,7 +187,7 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 		temp.open(originalName, flagsOpenExisting);
 		if (!temp.is_open())
 		{
-			Logger::queueError(Logger::FatalError,L"Could not open file %s",originalName);
+			accessError = tfm::format(L"Could not open file %s",originalName);
 			return false;
 		}
 		temp.close();
@@ -140,7 +198,7 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 		temp.open(fileName, exists ? flagsOpenExisting : flagsOverwrite);
 		if (!temp.is_open())
 		{
-			Logger::queueError(Logger::FatalError,L"Could not create file %s",fileName);
+			accessError = tfm::format(L"Could not create file %s",fileName);
 			return false;
 		}
 		temp.close();
@@ -153,11 +211,74 @@ bool GenericAssemblerFile::open(bool onlyCheck)
 	return false;
 }
 
+static bool filesEqual(const fs::path& a, const fs::path& b)
+{
+	std::error_code error;
+	if (!fs::exists(b, error) || fs::file_size(a, error) != fs::file_size(b, error) || error)
+		return false;
+
+	fs::ifstream streamA(a, fs::ifstream::in | fs::ifstream::binary);
+	fs::ifstream streamB(b, fs::ifstream::in | fs::ifstream::binary);
+	if (!streamA.is_open() || !streamB.is_open())
+		return false;
+
+	const size_t bufferSize = 65536;
+	std::vector<char> bufferA(bufferSize), bufferB(bufferSize);
+	while (streamA && streamB)
+	{
+		streamA.read(bufferA.data(), bufferSize);
+		streamB.read(bufferB.data(), bufferSize);
+		if (streamA.gcount() != streamB.gcount())
+			return false;
+		if (memcmp(bufferA.data(), bufferB.data(), (size_t) streamA.gcount()) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+void GenericAssemblerFile::replaceIfChanged()
+{
+	std::error_code error;
+
+	// keep the old file and its timestamp if nothing changed
+	if (filesEqual(writeName, fileName))
+	{
+		fs::remove(writeName, error);
+		return;
+	}
+
+	fs::rename(writeName, fileName, error);
+	if (error)
+	{
+		Logger::printError(Logger::Error,L"Could not replace file %s",fileName);
+		fs::remove(writeName, error);
+	}
+}
+
+void GenericAssemblerFile::close()
+{
+	dryRunOutput = nullptr;
+	if (!stream.is_open())
+		return;
+
+	stream.close();
+	if (writeName != fileName)
+		replaceIfChanged();
+}
+
 bool GenericAssemblerFile::write(void* data, size_t length)
 {
 	if (!isOpen())
 		return false;
 
+	if (dryRunOutput != nullptr)
+	{
+		dryRunOutput->write(virtualAddress-headerSize,data,length);
+		virtualAddress += length;
+		return true;
+	}
+
 	stream.write(reinterpret_cast<const char *>( data ), length);
 	virtualAddress += length;
 	return !stream.fail();
@@ -176,7 +297,7 @@ bool GenericAssemblerFile::seekVirtual(int64_t virtualAddress)
 	this->virtualAddress = virtualAddress;
 	int64_t physicalAddress = virtualAddress-headerSize;
 
-	if (isOpen())
+	if (stream.is_open())
 		stream.seekp(physicalAddress);
 
 	return true;
@@ -194,7 +315,7 @@ bool GenericAssemblerFile::seekPhysical(int64_t physicalAddress)
 
 	virtualAddress = physicalAddress+headerSize;
 
-	if (isOpen())
+	if (stream.is_open())
 		stream.seekp(physicalAddress);
 
 	return true;
@@ -236,6 +357,12 @@ void FileManager::reset()
 	setEndianness(Endianness::Little);
 }
 
+void FileManager::clear()
+{
+	files.clear();
+	reset();
+}
+
 bool FileManager::checkActiveFile()
 {
 	if (activeFile == nullptr)
@@ -263,6 +390,12 @@ void FileManager::addFile(std::shared_ptr<AssemblerFile> file)
 	files.push_back(file);
 }
 
+void FileManager::probeFiles()
+{
+	for (const std::shared_ptr<AssemblerFile>& file: files)
+		file->probeAccess();
+}
+
 void FileManager::closeFile()
 {
 	if (activeFile == nullptr)
@@ -286,6 +419,7 @@ bool FileManager::write(void* data, size_t length)
 		return false;
 	}
 
+	Profiler::countBytes(length);
 	return activeFile->write(data,length);
 }
 
@@ -371,6 +505,32 @@ bool FileManager::advanceMemory(size_t bytes)
 	return activeFile->seekVirtual(pos+bytes);
 }
 
+std::shared_ptr<AssemblerFile> FileManager::findFile(int64_t fileID)
+{
+	for (const std::shared_ptr<AssemblerFile>& file: files)
+	{
+		if ((int64_t)(intptr_t)file.get() == fileID)
+			return file;
+	}
+
+	if (activeFile != nullptr && (int64_t)(intptr_t)activeFile.get() == fileID)
+		return activeFile;
+
+	return nullptr;
+}
+
+// unnamed files are numbered in the order they were added. their id is the
+// address of the file object, which differs between runs
+std::wstring FileManager::getReportName(int64_t fileID)
+{
+	std::shared_ptr<AssemblerFile> file = findFile(fileID);
+	if (file != nullptr && !file->getFileName().empty())
+		return file->getFileName().wstring();
+
+	auto it = std::find(files.begin(),files.end(),file);
+	return tfm::format(L"file_%d",it - files.begin());
+}
+
 int64_t FileManager::getOpenFileID()
 {
 	if (!checkActiveFile())
@@ -6,6 +6,7 @@
 #include <memory>
 #include <vector>
 
+class DryRunOutput;
 class SymbolData;
 
 struct SymDataModuleInfo;
@@ -29,6 +30,8 @@ public:
 	virtual void beginSymData(SymbolData& symData) { };
 	virtual void endSymData(SymbolData& symData) { };
 	virtual const fs::path& getFileName() = 0;
+	// checks once whether the file can be opened, open(true) reuses the result
+	virtual void probeAccess() { };
 };
 
 class GenericAssemblerFile: public AssemblerFile
@@ -36,10 +39,11 @@ class GenericAssemblerFile: public AssemblerFile
 public:
 	GenericAssemblerFile(const fs::path& fileName, int64_t headerSize, bool overwrite);
 	GenericAssemblerFile(const fs::path& fileName, const fs::path& originalFileName, int64_t headerSize);
+	virtual ~GenericAssemblerFile();
 
 	virtual bool open(bool onlyCheck);
-	virtual void close() { if (stream.is_open()) stream.close(); };
-	virtual bool isOpen() { return stream.is_open(); };
+	virtual void close();
+	virtual bool isOpen() { return stream.is_open() || dryRunOutput != nullptr; };
 	virtual bool write(void* data, size_t length);
 	virtual int64_t getVirtualAddress() { return virtualAddress; };
 	virtual int64_t getPhysicalAddress() { return virtualAddress-headerSize; };
@@ -52,10 +56,14 @@ public:
 	const fs::path& getOriginalFileName() { return originalName; };
 	int64_t getOriginalHeaderSize() { return originalHeaderSize; };
 	void setHeaderSize(int64_t size) { headerSize = size; };
+	virtual void probeAccess();
 
 private:
 	enum Mode { Open, Create, Copy };
 
+	bool probe();
+	void replaceIfChanged();
+
 	Mode mode;
 	int64_t originalHeaderSize;
 	int64_t headerSize;
@@ -63,6 +71,11 @@ private:
 	fs::ofstream stream;
 	fs::path fileName;
 	fs::path originalName;
+	fs::path writeName;
+	DryRunOutput* dryRunOutput = nullptr;
+	bool accessChecked = false;
+	bool accessValid = false;
+	std::wstring accessError;
 };
 
 
@@ -72,8 +85,10 @@ public:
 	FileManager();
 	~FileManager();
 	void reset();
+	void clear();
 	bool openFile(std::shared_ptr<AssemblerFile> file, bool onlyCheck);
 	void addFile(std::shared_ptr<AssemblerFile> file);
+	void probeFiles();
 	bool hasOpenFile() { return activeFile != nullptr; };
 	void closeFile();
 	bool write(void* data, size_t length);
@@ -89,6 +104,8 @@ public:
 	bool advanceMemory(size_t bytes);
 	std::shared_ptr<AssemblerFile> getOpenFile() { return activeFile; };
 	int64_t getOpenFileID();
+	std::shared_ptr<AssemblerFile> findFile(int64_t fileID);
+	std::wstring getReportName(int64_t fileID);
 	void setEndianness(Endianness endianness) { this->endianness = endianness; };
 	Endianness getEndianness() { return endianness; }
 private:
@@ -4,6 +4,8 @@
 #include "Core/FileManager.h"
 #include "Util/FileSystem.h"
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
 
 #ifdef _WIN32
@@ -11,6 +13,8 @@
 #endif
 
 std::vector<Logger::QueueEntry> Logger::queue;
+size_t Logger::queueSize = 0;
+std::vector<size_t> Logger::queueLookup;
 std::vector<std::wstring> Logger::errors;
 bool Logger::error = false;
 bool Logger::fatalError = false;
@@ -18,29 +22,35 @@ bool Logger::errorOnWarning = false;
 bool Logger::silent = false;
 int Logger::suppressLevel = 0;
 
-std::wstring Logger::formatError(ErrorType type, const wchar_t* text)
+void Logger::formatError(std::wstring& dest, ErrorType type, const wchar_t* text)
 {
-	std::wstring position;
+	dest.clear();
 
 	if (!Global.memoryMode && Global.fileList.size() > 0)
 	{
-		const auto& fileName = Global.fileList.relativeWstring(Global.FileInfo.FileNum);
-		position = tfm::format(L"%s(%d) ", fileName, Global.FileInfo.LineNumber);
+		dest += Global.fileList.relativeWstring(Global.FileInfo.FileNum);
+		dest += L'(';
+		dest += std::to_wstring(Global.FileInfo.LineNumber);
+		dest += L") ";
 	}
 
 	switch (type)
 	{
 	case Warning:
-		return tfm::format(L"%swarning: %s",position,text);
+		dest += L"warning: ";
+		break;
 	case Error:
-		return tfm::format(L"%serror: %s",position,text);
+		dest += L"error: ";
+		break;
 	case FatalError:
-		return tfm::format(L"%sfatal error: %s",position,text);
+		dest += L"fatal error: ";
+		break;
 	case Notice:
-		return tfm::format(L"%snotice: %s",position,text);
+		dest += L"notice: ";
+		break;
 	}
 
-	return L"";
+	dest += text;
 }
 
 void Logger::setFlags(ErrorType type)
@@ -65,7 +75,7 @@ void Logger::setFlags(ErrorType type)
 
 void Logger::clear()
 {
-	queue.clear();
+	clearQueue();
 	errors.clear();
 	error = false;
 	fatalError = false;
@@ -113,16 +123,7 @@ void Logger::print(const std::wstring& text)
 
 void Logger::printError(ErrorType type, const std::wstring& text)
 {
-	if (suppressLevel)
-		return;
-
-	std::wstring errorText = formatError(type,text.c_str());
-	errors.push_back(errorText);
-
-	if (!silent)
-		printLine(errorText);
-
-	setFlags(type);
+	printError(type,text.c_str());
 }
 
 void Logger::printError(ErrorType type, const wchar_t* text)
@@ -130,24 +131,39 @@ void Logger::printError(ErrorType type, const wchar_t* text)
 	if (suppressLevel)
 		return;
 
-	std::wstring errorText = formatError(type,text);
-	errors.push_back(errorText);
+	std::wstring errorText;
+	formatError(errorText,type,text);
 
 	if (!silent)
 		printLine(errorText);
 
+	errors.push_back(std::move(errorText));
 	setFlags(type);
 }
 
 void Logger::queueError(ErrorType type, const std::wstring& text)
 {
-	if (suppressLevel)
-		return;
+	queueError(type,text.c_str());
+}
 
-	QueueEntry entry;
-	entry.type = type;
-	entry.text = formatError(type,text.c_str());
-	queue.push_back(entry);
+bool Logger::insertQueueLookup(size_t index)
+{
+	const QueueEntry& entry = queue[index];
+	size_t mask = queueLookup.size()-1;
+
+	for (size_t pos = entry.hash & mask; ; pos = (pos+1) & mask)
+	{
+		if (queueLookup[pos] == 0)
+		{
+			queueLookup[pos] = index+1;
+			return true;
+		}
+
+		const QueueEntry& other = queue[queueLookup[pos]-1];
+		if (other.hash == entry.hash && other.type == entry.type && other.fileNum == entry.fileNum
+			&& other.lineNumber == entry.lineNumber && other.text == entry.text)
+			return false;
+	}
 }
 
 void Logger::queueError(ErrorType type, const wchar_t* text)
@@ -155,15 +171,39 @@ void Logger::queueError(ErrorType type, const wchar_t* text)
 	if (suppressLevel)
 		return;
 
-	QueueEntry entry;
+	if (queueSize == queue.size())
+		queue.emplace_back();
+
+	QueueEntry& entry = queue[queueSize];
 	entry.type = type;
-	entry.text = formatError(type,text);
-	queue.push_back(entry);
+	entry.fileNum = Global.FileInfo.FileNum;
+	entry.lineNumber = Global.FileInfo.LineNumber;
+	formatError(entry.text,type,text);
+	entry.hash = std::hash<std::wstring>()(entry.text) ^ ((size_t)entry.fileNum << 16) ^ (size_t)entry.lineNumber;
+
+	// keep the table at most half full
+	if (queueLookup.size() < (queueSize+1)*2)
+	{
+		queueLookup.assign(std::max<size_t>(64,queueLookup.size()*2),0);
+		for (size_t i = 0; i < queueSize; i++)
+			insertQueueLookup(i);
+	}
+
+	// the same diagnostic at the same location is only reported once
+	if (insertQueueLookup(queueSize))
+		queueSize++;
+}
+
+void Logger::clearQueue()
+{
+	if (queueSize != 0)
+		std::fill(queueLookup.begin(),queueLookup.end(),0);
+	queueSize = 0;
 }
 
 void Logger::printQueue()
 {
-	for (size_t i = 0; i < queue.size(); i++)
+	for (size_t i = 0; i < queueSize; i++)
 	{
 		errors.push_back(queue[i].text);
 
@@ -207,9 +247,21 @@ void TempData::end()
 		file.close();
 }
 
+void TempData::appendChunk(const TempData& chunk)
+{
+	if (buffered)
+		buffer += chunk.buffer;
+	else if (file.isOpen())
+		file.write(chunk.buffer);
+
+	// continue with the file info the chunk ended with
+	fileNum = chunk.fileNum;
+	lineNumber = chunk.lineNumber;
+}
+
 void TempData::writeLine(int64_t memoryAddress, const std::wstring& text)
 {
-	if (file.isOpen())
+	if (isOpen())
 	{
 		wchar_t hexbuf[10] = {0};
 		swprintf(hexbuf, 10, L"%08X ", (int32_t) memoryAddress);
@@ -217,9 +269,14 @@ void TempData::writeLine(int64_t memoryAddress, const std::wstring& text)
 		while (str.size() < 70)
 			str += ' ';
 
-		str += tfm::format(L"; %S line %d",
-			Global.fileList.wstring(Global.FileInfo.FileNum),Global.FileInfo.LineNumber);
+		str += tfm::format(L"; %S line %d",Global.fileList.wstring(fileNum),lineNumber);
 
-		file.writeLine(str);
+		if (buffered)
+		{
+			buffer += str;
+			buffer += L'\n';
+		} else {
+			file.writeLine(str);
+		}
 	}
 }
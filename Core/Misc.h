@@ -51,8 +51,8 @@ public:
 	}
 
 	static void printQueue();
-	static void clearQueue() { queue.clear(); };
-	static std::vector<std::wstring> getErrors() { return errors; };
+	static void clearQueue();
+	static const std::vector<std::wstring>& getErrors() { return errors; };
 	static bool hasError() { return error; };
 	static bool hasFatalError() { return fatalError; };
 	static void setErrorOnWarning(bool b) { errorOnWarning = b; };
@@ -61,16 +61,25 @@ public:
 	static void suppressErrors() { ++suppressLevel; }
 	static void unsuppressErrors() { if (suppressLevel) --suppressLevel; }
 private:
-	static std::wstring formatError(ErrorType type, const wchar_t* text);
+	static void formatError(std::wstring& dest, ErrorType type, const wchar_t* text);
 	static void setFlags(ErrorType type);
+	static bool insertQueueLookup(size_t index);
 
 	struct QueueEntry
 	{
 		ErrorType type;
+		int fileNum;
+		int lineNumber;
+		size_t hash;
 		std::wstring text;
 	};
 
+	// queued diagnostics are discarded on every validation pass. entries past
+	// queueSize are kept so their string buffers can be reused, and the
+	// lookup table (indices+1, open addressing) drops duplicates
 	static std::vector<QueueEntry> queue;
+	static size_t queueSize;
+	static std::vector<size_t> queueLookup;
 	static std::vector<std::wstring> errors;
 	static bool error;
 	static bool fatalError;
@@ -79,6 +88,9 @@ private:
 	static int suppressLevel;
 };
 
+// Writes the temp listing. A TempData can also collect its lines in memory
+// as a chunk, chunks formatted on different threads are then appended to
+// the file in order.
 class TempData
 {
 public:
@@ -86,8 +98,15 @@ public:
 	void clear() { file.setFileName({}); }
 	void start();
 	void end();
+	void startChunk() { buffered = true; buffer.clear(); }
+	void appendChunk(const TempData& chunk);
+	void setFileInfo(int fileNum, int lineNumber) { this->fileNum = fileNum; this->lineNumber = lineNumber; }
 	void writeLine(int64_t memoryAddress, const std::wstring& text);
-	bool isOpen() { return file.isOpen(); }
+	bool isOpen() { return buffered || file.isOpen(); }
 private:
 	TextFile file;
+	bool buffered = false;
+	std::wstring buffer;
+	int fileNum = 0;
+	int lineNumber = 0;
 };
@@ -0,0 +1,255 @@
+#include "Core/ResultCache.h"
+
+#include "Core/Assembler.h"
+#include "Core/Common.h"
+#include "Util/ByteArray.h"
+#include "Util/CRC.h"
+#include "Util/Util.h"
+
+#include <tinyformat.h>
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	const wchar_t* manifestName = L"manifest.txt";
+
+	uint64_t getStringHash(const std::wstring& text)
+	{
+		std::string data = convertWStringToUtf8(text);
+		return getFnv1a64((const unsigned char*) data.data(),data.size());
+	}
+
+	bool getFileHash(const fs::path& fileName, uint64_t& hash)
+	{
+		std::error_code error;
+		if (!fs::is_regular_file(fileName,error))
+			return false;
+
+		ByteArray data = ByteArray::fromFile(fileName);
+		hash = getFnv1a64(data.data(),data.size());
+		return true;
+	}
+
+	std::wstring getAbsoluteName(const fs::path& fileName)
+	{
+		if (fileName.empty())
+			return L"";
+		return getAbsolutePath(fileName).wstring();
+	}
+
+	bool writeText(const fs::path& fileName, const std::wstring& text)
+	{
+		std::string data = convertWStringToUtf8(text);
+
+		fs::ofstream stream(fileName, fs::ofstream::out | fs::ofstream::binary | fs::ofstream::trunc);
+		if (!stream.is_open())
+			return false;
+
+		stream.write(data.data(),data.size());
+		return !stream.fail();
+	}
+
+	bool readLines(const fs::path& fileName, std::vector<std::wstring>& lines)
+	{
+		std::error_code error;
+		if (!fs::exists(fileName,error))
+			return false;
+
+		ByteArray data = ByteArray::fromFile(fileName);
+		std::wstring text = convertUtf8ToWString(std::string((const char*) data.data(),data.size()).c_str());
+
+		size_t start = 0;
+		while (start < text.size())
+		{
+			size_t end = text.find(L'\n',start);
+			if (end == std::wstring::npos)
+				end = text.size();
+
+			lines.push_back(text.substr(start,end-start));
+			start = end+1;
+		}
+
+		return true;
+	}
+}
+
+ResultCache::ResultCache(const fs::path& directory, const ArmipsArguments& settings)
+{
+	// everything that can change the outputs without changing an input file
+	std::wstring key = tfm::format(L"armips %d.%d.%d\n",ARMIPS_VERSION_MAJOR,ARMIPS_VERSION_MINOR,ARMIPS_VERSION_REVISION);
+	key += tfm::format(L"root %s\n",getWorkingDirectory().wstring());
+	key += tfm::format(L"input %s\n",getAbsoluteName(settings.inputFileName));
+	key += tfm::format(L"temp %s\n",getAbsoluteName(settings.tempFileName));
+	key += tfm::format(L"sym%d %s\n",settings.symFileVersion,getAbsoluteName(settings.symFileName));
+	key += tfm::format(L"dep %s\n",getAbsoluteName(settings.dependencyFileName));
+	key += tfm::format(L"freemap %s\n",getAbsoluteName(settings.freeMapFileName));
+	key += tfm::format(L"prelude %s\n",getAbsoluteName(settings.preludeFileName));
+	key += tfm::format(L"saveprelude %s\n",getAbsoluteName(settings.savePreludeFileName));
+	key += tfm::format(L"flags %d %d\n",settings.errorOnWarning,settings.useAbsoluteFileNames);
+
+	for (const EquationDefinition& equ: settings.equList)
+		key += tfm::format(L"equ %s %s\n",equ.name,equ.value);
+	for (const LabelDefinition& label: settings.labels)
+		key += tfm::format(L"label %s %d\n",label.originalName,label.value);
+
+	entryDirectory = directory / tfm::format(L"%016llX",getStringHash(key));
+	rootFileName = getAbsolutePath(settings.inputFileName);
+}
+
+bool ResultCache::restore(bool skipUnchangedOutputs) const
+{
+	std::vector<std::wstring> lines;
+	if (!readLines(entryDirectory / manifestName,lines))
+		return false;
+
+	// check all inputs and load all stored outputs before touching any file
+	std::vector<std::pair<fs::path,ByteArray>> outputs;
+	bool hasRootFile = false;
+	for (const std::wstring& line: lines)
+	{
+		if (line.compare(0,6,L"input ") == 0 && line.size() > 23)
+		{
+			uint64_t hash;
+			if (!getFileHash(line.substr(23),hash) || tfm::format(L"%016llX",hash) != line.substr(6,16))
+				return false;
+			if (getAbsolutePath(line.substr(23)) == rootFileName)
+				hasRootFile = true;
+		} else if (line.compare(0,8,L"missing ") == 0)
+		{
+			std::error_code error;
+			if (fs::exists(line.substr(8),error))
+				return false;
+		} else if (line.compare(0,7,L"output ") == 0 && line.size() > 24)
+		{
+			// another instance may have removed the data since the manifest
+			// was read, so it has to be there and match the recorded hash
+			std::error_code error;
+			fs::path dataName = entryDirectory / (line.substr(7,16) + L".bin");
+			if (!fs::is_regular_file(dataName,error))
+				return false;
+
+			ByteArray data = ByteArray::fromFile(dataName);
+			if (tfm::format(L"%016llX",getFnv1a64(data.data(),data.size())) != line.substr(7,16))
+				return false;
+
+			outputs.emplace_back(line.substr(24),std::move(data));
+		} else {
+			return false;
+		}
+	}
+
+	// every run reads its source file, anything else isn't a complete entry
+	if (!hasRootFile)
+		return false;
+
+	for (auto& output: outputs)
+	{
+		const fs::path& fileName = output.first;
+		ByteArray& data = output.second;
+
+		if (skipUnchangedOutputs && fs::exists(fileName))
+		{
+			ByteArray current = ByteArray::fromFile(fileName);
+			if (current.size() == data.size() && memcmp(current.data(),data.data(),data.size()) == 0)
+				continue;
+		}
+
+		std::error_code error;
+		if (fileName.has_parent_path())
+			fs::create_directories(fileName.parent_path(),error);
+
+		if (!data.toFile(fileName))
+			return false;
+	}
+
+	return true;
+}
+
+bool ResultCache::store(const std::set<fs::path>& inputs, const std::set<fs::path>& outputs) const
+{
+	std::wstring manifest;
+	for (const fs::path& input: inputs)
+	{
+		// files modified in place can't be restored from their own output
+		if (outputs.find(input) != outputs.end())
+			return false;
+
+		uint64_t hash;
+		std::error_code error;
+		if (getFileHash(input,hash))
+			manifest += tfm::format(L"input %016llX %s\n",hash,input.wstring());
+		else if (!fs::exists(input,error))
+			manifest += tfm::format(L"missing %s\n",input.wstring());
+		else
+			return false;
+	}
+
+	std::error_code error;
+	fs::create_directories(entryDirectory,error);
+
+	// outputs are stored under the hash of their content, so a file that
+	// exists already has the right data and is never written over. other
+	// instances using the same entry only ever see complete files
+	std::set<fs::path> dataNames;
+	for (const fs::path& output: outputs)
+	{
+		if (!fs::is_regular_file(output,error))
+			return false;
+
+		ByteArray data = ByteArray::fromFile(output);
+		uint64_t hash = getFnv1a64(data.data(),data.size());
+		fs::path dataName = tfm::format(L"%016llX.bin",hash);
+		dataNames.insert(dataName);
+
+		fs::path fullName = entryDirectory / dataName;
+		if (!fs::is_regular_file(fullName,error))
+		{
+			fs::path tempName = getTemporaryFileName(fullName);
+			if (!data.toFile(tempName))
+			{
+				fs::remove(tempName,error);
+				return false;
+			}
+
+			fs::rename(tempName,fullName,error);
+			if (error)
+			{
+				fs::remove(tempName,error);
+				return false;
+			}
+		}
+
+		manifest += tfm::format(L"output %016llX %s\n",hash,output.wstring());
+	}
+
+	// the new entry only becomes visible with the rename of the manifest
+	fs::path tempName = getTemporaryFileName(entryDirectory / manifestName);
+	if (!writeText(tempName,manifest))
+	{
+		fs::remove(tempName,error);
+		return false;
+	}
+
+	fs::rename(tempName,entryDirectory / manifestName,error);
+	if (error)
+	{
+		fs::remove(tempName,error);
+		return false;
+	}
+
+	// remove outputs of older entries. if another instance still needs one,
+	// restore notices the missing data and the run is assembled normally
+	for (fs::directory_iterator it(entryDirectory,error), end; !error && it != end; it.increment(error))
+	{
+		const fs::path& fileName = it->path();
+		if (fileName.extension() == L".bin" && dataNames.find(fileName.filename()) == dataNames.end())
+		{
+			std::error_code removeError;
+			fs::remove(fileName,removeError);
+		}
+	}
+
+	return true;
+}
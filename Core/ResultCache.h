@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Util/FileSystem.h"
+
+#include <cstdint>
+#include <set>
+#include <string>
+
+struct ArmipsArguments;
+
+// Outputs of complete runs, stored in a directory and keyed by a hash of the
+// armips version and all settings of the run. Each entry records the hash of
+// every file the run read, so a later run with the same settings can restore
+// the outputs without parsing anything if none of these files changed. Runs
+// whose inputs changed while they were read are not stored.
+class ResultCache
+{
+public:
+	ResultCache(const fs::path& directory, const ArmipsArguments& settings);
+
+	// writes the cached outputs if the entry is still valid
+	bool restore(bool skipUnchangedOutputs) const;
+	bool store(const std::set<fs::path>& inputs, const std::set<fs::path>& outputs) const;
+private:
+	fs::path entryDirectory;
+	fs::path rootFileName;
+};
@@ -5,6 +5,7 @@
 #include "FileManager.h"
 
 #include <algorithm>
+#include <tuple>
 
 SymbolData::SymbolData()
 {
@@ -122,8 +123,32 @@ void SymbolData::writeNocashSym()
 	file.close();
 }
 
+void SymbolData::reserve(size_t labelCount, size_t dataCount)
+{
+	modules[0].symbols.reserve(labelCount);
+	modules[0].data.reserve(dataCount);
+}
+
+// entries are only appended while collecting, duplicates are removed once
+// all of them are known
+void SymbolData::sortEntries()
+{
+	for (SymDataModule& module: modules)
+	{
+		std::sort(module.symbols.begin(),module.symbols.end(),[](const SymDataSymbol& a, const SymDataSymbol& b)
+		{
+			return std::tie(a.address,a.name) < std::tie(b.address,b.name);
+		});
+		module.symbols.erase(std::unique(module.symbols.begin(),module.symbols.end()),module.symbols.end());
+
+		std::sort(module.data.begin(),module.data.end());
+		module.data.erase(std::unique(module.data.begin(),module.data.end()),module.data.end());
+	}
+}
+
 void SymbolData::write()
 {
+	sortEntries();
 	writeNocashSym();
 }
 
@@ -135,13 +160,6 @@ void SymbolData::addLabel(int64_t memoryAddress, const std::wstring& name)
 	SymDataSymbol sym;
 	sym.address = memoryAddress;
 	sym.name = name;
-
-	for (SymDataSymbol& symbol: modules[currentModule].symbols)
-	{
-		if (symbol.address == sym.address && symbol.name == sym.name)
-			return;
-	}
-
 	modules[currentModule].symbols.push_back(sym);
 }
 
@@ -154,7 +172,7 @@ void SymbolData::addData(int64_t address, size_t size, DataType type)
 	data.address = address;
 	data.size = size;
 	data.type = type;
-	modules[currentModule].data.insert(data);
+	modules[currentModule].data.push_back(data);
 }
 
 size_t SymbolData::addFileName(const std::wstring& fileName)
@@ -3,7 +3,6 @@
 #include "Util/FileSystem.h"
 
 #include <cstdint>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -18,6 +17,11 @@ struct SymDataSymbol
 	{
 		return address < other.address;
 	}
+
+	bool operator==(const SymDataSymbol& other) const
+	{
+		return address == other.address && name == other.name;
+	}
 };
 
 struct SymDataAddressInfo
@@ -59,6 +63,11 @@ struct SymDataData
 
 		return type < other.type;
 	}
+
+	bool operator==(const SymDataData& other) const
+	{
+		return address == other.address && size == other.size && type == other.type;
+	}
 };
 
 struct SymDataModule
@@ -66,7 +75,7 @@ struct SymDataModule
 	AssemblerFile* file;
 	std::vector<SymDataSymbol> symbols;
 	std::vector<SymDataFunction> functions;
-	std::set<SymDataData> data;
+	std::vector<SymDataData> data;
 };
 
 struct SymDataModuleInfo
@@ -84,6 +93,7 @@ public:
 	void setNocashSymFileName(const fs::path& name, int version) { nocashSymFileName = name; nocashSymVersion = version; };
 	void write();
 	void setEnabled(bool b) { enabled = b; };
+	void reserve(size_t labelCount, size_t dataCount);
 
 	void addLabel(int64_t address, const std::wstring& name);
 	void addData(int64_t address, size_t size, DataType type);
@@ -92,6 +102,7 @@ public:
 	void startFunction(int64_t address);
 	void endFunction(int64_t address);
 private:
+	void sortEntries();
 	void writeNocashSym();
 	size_t addFileName(const std::wstring& fileName);
 
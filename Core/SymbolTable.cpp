@@ -5,22 +5,43 @@
 #include "Util/FileClasses.h"
 #include "Util/Util.h"
 
-#include <tinyformat.h>
+#include <algorithm>
 
 const wchar_t validSymbolCharacters[] = L"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_.";
 
-bool operator<(SymbolKey const& lhs, SymbolKey const& rhs)
+SymbolKey::SymbolKey(const std::wstring& name, int file, int section)
+	: name(name), file(file), section(section)
 {
-	if (lhs.file != rhs.file)
-		return lhs.file < rhs.file;
-	if (lhs.section != rhs.section)
-		return lhs.section < rhs.section;
-	return lhs.name.compare(rhs.name) < 0;
+	valid = SymbolTable::isValidSymbolName(name);
+
+	switch (SymbolTable::getSymbolScope(name))
+	{
+	case SymbolScope::Static:
+		// static label, @. the section doesn't matter
+		this->section = -1;
+		break;
+	case SymbolScope::Local:
+		// local label, @@. the file doesn't matter
+		this->file = -1;
+		break;
+	case SymbolScope::Global:
+		// global label. neither file nor section matters
+		this->file = this->section = -1;
+		break;
+	}
+
+	hash = std::hash<std::wstring>()(name);
+	hash ^= (std::hash<int>()(this->file)*31 + std::hash<int>()(this->section)) * 0x9E3779B9;
+}
+
+bool operator==(SymbolKey const& lhs, SymbolKey const& rhs)
+{
+	return lhs.hash == rhs.hash && lhs.file == rhs.file && lhs.section == rhs.section && lhs.name == rhs.name;
 }
 
 SymbolTable::SymbolTable()
 {
-	uniqueCount = 0;
+	checkpoint.active = false;
 }
 
 SymbolTable::~SymbolTable()
@@ -33,35 +54,29 @@ void SymbolTable::clear()
 	symbols.clear();
 	labels.clear();
 	equationsCount = 0;
-	uniqueCount = 0;
+	generatedLocal.clear();
+	checkpoint.active = false;
+	checkpoint.addedSymbols.clear();
 }
 
-void SymbolTable::setFileSectionValues(const std::wstring& symbol, int& file, int& section)
+SymbolScope SymbolTable::getSymbolScope(const std::wstring& symbol)
 {
-	if (symbol[0] == '@')
-	{
-		if (symbol[1] != '@')
-		{
-			// static label, @. the section doesn't matter
-			section = -1;
-		} else {
-			// local label, @@. the file doesn't matter
-			file = -1;
-		}
-	} else {
-		// global label. neither file nor section matters
-		file = section = -1;
-	}
+	if (isLocalSymbol(symbol))
+		return SymbolScope::Local;
+	if (isStaticSymbol(symbol))
+		return SymbolScope::Static;
+	return SymbolScope::Global;
 }
 
 std::shared_ptr<Label> SymbolTable::getLabel(const std::wstring& symbol, int file, int section)
 {
-	if (!isValidSymbolName(symbol))
-		return nullptr;
+	return getLabel(SymbolKey(symbol,file,section),section);
+}
 
-	int actualSection = section;
-	setFileSectionValues(symbol,file,section);
-	SymbolKey key = { symbol, file, section };
+std::shared_ptr<Label> SymbolTable::getLabel(const SymbolKey& key, int section)
+{
+	if (!key.valid)
+		return nullptr;
 
 	// find label, create new one if it doesn't exist
 	auto it = symbols.find(key);
@@ -69,12 +84,15 @@ std::shared_ptr<Label> SymbolTable::getLabel(const std::wstring& symbol, int fil
 	{
 		SymbolInfo value = { LabelSymbol, labels.size() };
 		symbols[key] = value;
+		if (checkpoint.active)
+			checkpoint.addedSymbols.push_back(key);
 		
-		std::shared_ptr<Label> result = std::make_shared<Label>(symbol);
-		if (section == actualSection)
+		std::shared_ptr<Label> result = std::make_shared<Label>(key.name);
+		if (key.section == section)
 			result->setSection(section);			// local, set section of parent
 		else
-			result->setSection(actualSection+1);	// global, set section of children
+			result->setSection(section+1);			// global, set section of children
+		result->setGenerated(isGeneratedLabel(key.name));
 		labels.push_back(result);
 		return result;
 	}
@@ -88,14 +106,8 @@ std::shared_ptr<Label> SymbolTable::getLabel(const std::wstring& symbol, int fil
 
 bool SymbolTable::symbolExists(const std::wstring& symbol, int file, int section)
 {
-	if (!isValidSymbolName(symbol))
-		return false;
-
-	setFileSectionValues(symbol,file,section);
-
-	SymbolKey key = { symbol, file, section };
-	auto it = symbols.find(key);
-	return it != symbols.end();
+	SymbolKey key(symbol,file,section);
+	return key.valid && symbols.find(key) != symbols.end();
 }
 
 bool SymbolTable::isValidSymbolName(const std::wstring& symbol)
@@ -137,17 +149,14 @@ bool SymbolTable::isValidSymbolCharacter(wchar_t character, bool first)
 
 bool SymbolTable::addEquation(const std::wstring& name, int file, int section, size_t referenceIndex)
 {
-	if (!isValidSymbolName(name))
-		return false;
-
-	if (symbolExists(name,file,section))
+	SymbolKey key(name,file,section);
+	if (!key.valid || symbols.find(key) != symbols.end())
 		return false;
-	
-	setFileSectionValues(name,file,section);
 
-	SymbolKey key = { name, file, section };
 	SymbolInfo value = { EquationSymbol, referenceIndex };
 	symbols[key] = value;
+	if (checkpoint.active)
+		checkpoint.addedSymbols.push_back(key);
 
 	equationsCount++;
 	return true;
@@ -155,9 +164,11 @@ bool SymbolTable::addEquation(const std::wstring& name, int file, int section, s
 
 bool SymbolTable::findEquation(const std::wstring& name, int file, int section, size_t& dest)
 {
-	setFileSectionValues(name,file,section);
-	
-	SymbolKey key = { name, file, section };
+	return findEquation(SymbolKey(name,file,section),dest);
+}
+
+bool SymbolTable::findEquation(const SymbolKey& key, size_t& dest)
+{
 	auto it = symbols.find(key);
 	if (it == symbols.end() || it->second.type != EquationSymbol)
 		return false;
@@ -166,17 +177,52 @@ bool SymbolTable::findEquation(const std::wstring& name, int file, int section,
 	return true;
 }
 
-// TODO: better
+static const wchar_t uniqueLabelPrefix[] = L"__armips_label_";
+static const size_t uniqueLabelPrefixLength = sizeof(uniqueLabelPrefix)/sizeof(wchar_t)-1;
+
+// unique labels are numbered, the name is only built for the token stream
 std::wstring SymbolTable::getUniqueLabelName(bool local)
 {
-	std::wstring name = tfm::format(L"__armips_label_%08x__",uniqueCount++);
+	static const wchar_t digits[] = L"0123456789abcdef";
+
+	std::wstring name;
+	name.reserve(uniqueLabelPrefixLength+14);
 	if (local)
-		name = L"@@" + name;
+		name += L"@@";
+	name += uniqueLabelPrefix;
 
-	generatedLabels.insert(name);
+	size_t id = generatedLocal.size();
+	for (int shift = 28; shift >= 0; shift -= 4)
+		name += digits[(id >> shift) & 0xF];
+
+	name += L"__";
+	generatedLocal.push_back(local);
 	return name;
 }
 
+bool SymbolTable::isGeneratedLabel(const std::wstring& name) const
+{
+	size_t pos = isLocalSymbol(name) ? 2 : 0;
+	if (name.size() != pos+uniqueLabelPrefixLength+10 || name.compare(pos,uniqueLabelPrefixLength,uniqueLabelPrefix) != 0
+		|| name.compare(name.size()-2,2,L"__") != 0)
+		return false;
+
+	size_t id = 0;
+	for (size_t i = pos+uniqueLabelPrefixLength; i < name.size()-2; i++)
+	{
+		wchar_t c = name[i];
+		if (c >= '0' && c <= '9')
+			id = id*16 + (c-'0');
+		else if (c >= 'a' && c <= 'f')
+			id = id*16 + (c-'a'+10);
+		else
+			return false;
+	}
+
+	// only numbers that were actually issued, with the same scope
+	return id < generatedLocal.size() && generatedLocal[id] == (pos != 0);
+}
+
 void SymbolTable::addLabels(const std::vector<LabelDefinition>& labels)
 {
 	for (const LabelDefinition& def: labels)
@@ -198,6 +244,68 @@ void SymbolTable::addLabels(const std::vector<LabelDefinition>& labels)
 	}
 }
 
+void SymbolTable::setCheckpoint()
+{
+	checkpoint.active = true;
+	checkpoint.labelCount = labels.size();
+	checkpoint.equationsCount = equationsCount;
+	checkpoint.generatedCount = generatedLocal.size();
+	checkpoint.addedSymbols.clear();
+}
+
+void SymbolTable::rollback()
+{
+	if (!checkpoint.active)
+		return;
+
+	for (const SymbolKey& key: checkpoint.addedSymbols)
+		symbols.erase(key);
+	checkpoint.addedSymbols.clear();
+
+	labels.resize(checkpoint.labelCount);
+	equationsCount = checkpoint.equationsCount;
+	generatedLocal.resize(checkpoint.generatedCount);
+}
+
+std::vector<std::pair<std::wstring,size_t>> SymbolTable::getGlobalEquations() const
+{
+	std::vector<std::pair<std::wstring,size_t>> result;
+	for (const auto& it: symbols)
+	{
+		if (it.second.type == EquationSymbol && it.first.file == -1 && it.first.section == -1)
+			result.emplace_back(it.first.name,it.second.index);
+	}
+
+	std::sort(result.begin(),result.end());
+	return result;
+}
+
+std::vector<LabelDefinition> SymbolTable::getGlobalLabels() const
+{
+	std::vector<LabelDefinition> result;
+	for (const auto& it: symbols)
+	{
+		if (it.second.type != LabelSymbol || it.first.file != -1 || it.first.section != -1)
+			continue;
+
+		const std::shared_ptr<Label>& label = labels[it.second.index];
+		if (!label->isDefined() || label->isGenerated())
+			continue;
+
+		LabelDefinition def;
+		def.name = it.first.name;
+		def.originalName = label->getOriginalName();
+		def.value = label->getValue();
+		result.push_back(def);
+	}
+
+	std::sort(result.begin(),result.end(),[](const LabelDefinition& a, const LabelDefinition& b)
+	{
+		return a.name < b.name;
+	});
+	return result;
+}
+
 int SymbolTable::findSection(int64_t address)
 {
 	int64_t smallestBefore = -1;
@@ -1,26 +1,42 @@
 #pragma once
 
-#include <map>
+#include "Util/MemoryStats.h"
+
 #include <memory>
-#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 struct LabelDefinition;
 
+enum class SymbolScope { Global, Static, Local };
+
+// name of a symbol with its scope already applied: file and section are -1
+// if the scope doesn't depend on them. built once per identifier, so lookups
+// only need the precomputed hash and a single string comparison
 struct SymbolKey
 {
+	SymbolKey() = default;
+	SymbolKey(const std::wstring& name, int file, int section);
+
 	std::wstring name;
-	int file;
-	int section;
+	int file = -1;
+	int section = -1;
+	size_t hash = 0;
+	bool valid = false;
 };
 
-bool operator<(SymbolKey const& lhs, SymbolKey const& rhs);
+bool operator==(SymbolKey const& lhs, SymbolKey const& rhs);
 
-class Label
+struct SymbolKeyHash
+{
+	size_t operator()(const SymbolKey& key) const { return key.hash; }
+};
+
+class Label: public MemoryTrackedObject<Label,MemoryCategory::Symbols>
 {
 public:
-	Label(std::wstring name): name(name),defined(false),data(false),updateInfo(true),info(0) { };
+	Label(std::wstring name): name(name),defined(false),data(false),updateInfo(true),generated(false),info(0) { };
 	const std::wstring getName() { return name; };
 	void setOriginalName(const std::wstring& name) { originalName = name; }
 	const std::wstring getOriginalName() { return originalName.empty() ? name : originalName; }
@@ -37,6 +53,8 @@ public:
 	int getInfo() { return info; };
 	void setUpdateInfo(bool b) { updateInfo = b; };
 	bool getUpdateInfo() { return updateInfo; };
+	void setGenerated(bool b) { generated = b; }
+	bool isGenerated() { return generated; }
 	void setSection(int num) { section = num; }
 	int getSection() { return section; }
 private:
@@ -47,6 +65,7 @@ private:
 	bool defined;
 	bool data;
 	bool updateInfo;
+	bool generated;
 	int info;
 	int section;
 };
@@ -63,19 +82,26 @@ public:
 	static bool isLocalSymbol(const std::wstring& symbol, size_t pos = 0) { return symbol.size() >= pos+2 && symbol[pos+0] == '@' && symbol[pos+1] == '@'; };
 	static bool isStaticSymbol(const std::wstring& symbol, size_t pos = 0) { return symbol.size() >= pos+1 && symbol[pos+0] == '@'; };
 	static bool isGlobalSymbol(const std::wstring& symbol, size_t pos = 0) { return !isLocalSymbol(symbol) && !isStaticSymbol(symbol); };
+	static SymbolScope getSymbolScope(const std::wstring& symbol);
 
 	std::shared_ptr<Label> getLabel(const std::wstring& symbol, int file, int section);
+	std::shared_ptr<Label> getLabel(const SymbolKey& key, int section);
 	bool addEquation(const std::wstring& name, int file, int section, size_t referenceIndex);
 	bool findEquation(const std::wstring& name, int file, int section, size_t& dest);
+	bool findEquation(const SymbolKey& key, size_t& dest);
 	void addLabels(const std::vector<LabelDefinition>& labels);
+	void setCheckpoint();
+	void rollback();
+	std::vector<std::pair<std::wstring,size_t>> getGlobalEquations() const;
+	std::vector<LabelDefinition> getGlobalLabels() const;
 	int findSection(int64_t address);
 
 	std::wstring getUniqueLabelName(bool local = false);
 	size_t getLabelCount() { return labels.size(); };
+	const std::vector<std::shared_ptr<Label>>& getLabels() const { return labels; }
 	size_t getEquationCount() { return equationsCount; };
-	bool isGeneratedLabel(const std::wstring& name) { return generatedLabels.find(name) != generatedLabels.end(); }
+	bool isGeneratedLabel(const std::wstring& name) const;
 private:
-	void setFileSectionValues(const std::wstring& symbol, int& file, int& section);
 
 	enum SymbolType { LabelSymbol, EquationSymbol };
 	struct SymbolInfo
@@ -84,9 +110,20 @@ private:
 		size_t index;
 	};
 
-	std::map<SymbolKey,SymbolInfo> symbols;
+	std::unordered_map<SymbolKey,SymbolInfo,SymbolKeyHash> symbols;
 	std::vector<std::shared_ptr<Label>> labels;
 	size_t equationsCount;
-	size_t uniqueCount;
-	std::set<std::wstring> generatedLabels;
+	// one entry per number issued by getUniqueLabelName, true if the name was
+	// local. user labels can use the same pattern with other numbers or scopes
+	std::vector<bool> generatedLocal;
+
+	// symbols added after the checkpoint, removed again by rollback
+	struct Checkpoint
+	{
+		bool active;
+		size_t labelCount;
+		size_t equationsCount;
+		size_t generatedCount;
+		std::vector<SymbolKey> addedSymbols;
+	} checkpoint;
 };
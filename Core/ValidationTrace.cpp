@@ -0,0 +1,208 @@
+#include "Core/ValidationTrace.h"
+
+#include "Core/Common.h"
+#include "Core/FileManager.h"
+#include "Core/SymbolTable.h"
+#include "Util/Util.h"
+
+#include <tinyformat.h>
+
+bool ValidationTrace::enabled = false;
+size_t ValidationTrace::changeCount = 0;
+std::vector<std::pair<int,int>> ValidationTrace::currentCommands;
+std::vector<ValidationTrace::LabelState> ValidationTrace::labelStates;
+std::map<ValidationTrace::AreaKey,AllocationMapEntry> ValidationTrace::areaStates;
+std::vector<ValidationTrace::Pass> ValidationTrace::passes;
+
+void ValidationTrace::setEnabled(bool state)
+{
+	changeCount = 0;
+	currentCommands.clear();
+	labelStates.clear();
+	areaStates.clear();
+	passes.clear();
+
+	enabled = state;
+}
+
+void ValidationTrace::addCommand(int fileNum, int line)
+{
+	changeCount++;
+	currentCommands.emplace_back(fileNum,line);
+}
+
+void ValidationTrace::collectLabelChanges(Pass& pass)
+{
+	const auto& labels = Global.symbolTable.getLabels();
+	bool first = labelStates.empty();
+	labelStates.resize(labels.size(),{ false, 0 });
+
+	for (size_t i = 0; i < labels.size(); i++)
+	{
+		LabelState state = { labels[i]->isDefined(), labels[i]->getValue() };
+		LabelState& previous = labelStates[i];
+
+		// the first pass is where everything gets its initial value
+		if (!first && state.defined && (!previous.defined || previous.value != state.value))
+			pass.labels.push_back({ labels[i]->getOriginalName(), previous.defined, previous.value, state.value });
+
+		previous = state;
+	}
+}
+
+void ValidationTrace::collectAreaChanges(Pass& pass)
+{
+	bool first = pass.number == 0;
+
+	std::map<AreaKey,AllocationMapEntry> states;
+	for (AllocationMapEntry& entry: Allocations::collectMap())
+	{
+		AreaKey key(entry.fileID,entry.position);
+
+		// -1 marks an area that didn't exist in the previous pass
+		auto it = areaStates.find(key);
+		int64_t oldSpace = it != areaStates.end() ? it->second.space : -1;
+		int64_t oldUsage = it != areaStates.end() ? it->second.usage : -1;
+		if (!first && (oldSpace != entry.space || oldUsage != entry.usage))
+		{
+			pass.areas.push_back({ entry.type, g_fileManager->getReportName(entry.fileID), entry.position,
+				oldSpace, entry.space, oldUsage, entry.usage });
+		}
+
+		states[key] = std::move(entry);
+	}
+
+	for (const auto& it: areaStates)
+	{
+		if (states.find(it.first) == states.end())
+		{
+			const AllocationMapEntry& entry = it.second;
+			pass.areas.push_back({ entry.type, g_fileManager->getReportName(entry.fileID), entry.position,
+				entry.space, -1, entry.usage, -1 });
+		}
+	}
+
+	areaStates = std::move(states);
+}
+
+void ValidationTrace::endPass(int number, bool revalidate)
+{
+	if (!enabled)
+		return;
+
+	Pass pass;
+	pass.number = number;
+	pass.revalidate = revalidate;
+	pass.commands = std::move(currentCommands);
+	currentCommands.clear();
+
+	collectLabelChanges(pass);
+	collectAreaChanges(pass);
+
+	passes.push_back(std::move(pass));
+}
+
+static std::wstring formatTraceValue(int64_t value)
+{
+	return value < 0 ? L"-" : tfm::format(L"%llX",value);
+}
+
+static std::wstring formatTraceJsonValue(int64_t value)
+{
+	return value < 0 ? L"null" : tfm::format(L"%d",value);
+}
+
+bool ValidationTrace::write(const fs::path& fileName)
+{
+	bool json = fileName.extension() == L".json";
+	std::wstring text;
+
+	if (json)
+		text += L"{\n  \"passes\": [";
+
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		const Pass& pass = passes[i];
+
+		// every command changes in the first pass, only count them there
+		bool listCommands = pass.number != 0;
+
+		if (json)
+		{
+			text += i == 0 ? L"\n" : L",\n";
+			text += tfm::format(L"    {\n      \"pass\": %d,\n      \"revalidate\": %s,\n      \"changedCommands\": %d",
+				pass.number,pass.revalidate ? L"true" : L"false",pass.commands.size());
+
+			if (listCommands)
+			{
+				text += L",\n      \"commands\": [";
+				for (size_t k = 0; k < pass.commands.size(); k++)
+				{
+					text += k == 0 ? L"\n" : L",\n";
+					text += tfm::format(L"        { \"file\": \"%s\", \"line\": %d }",
+						escapeJsonString(Global.fileList.relativeWstring(pass.commands[k].first)),pass.commands[k].second);
+				}
+				text += pass.commands.empty() ? L"]" : L"\n      ]";
+			}
+
+			text += L",\n      \"labels\": [";
+			for (size_t k = 0; k < pass.labels.size(); k++)
+			{
+				const LabelChange& label = pass.labels[k];
+				text += k == 0 ? L"\n" : L",\n";
+				text += tfm::format(L"        { \"name\": \"%s\", \"old\": %s, \"new\": %d }",escapeJsonString(label.name),
+					label.wasDefined ? tfm::format(L"%d",label.oldValue) : std::wstring(L"null"),label.newValue);
+			}
+			text += pass.labels.empty() ? L"]" : L"\n      ]";
+
+			text += L",\n      \"areas\": [";
+			for (size_t k = 0; k < pass.areas.size(); k++)
+			{
+				const AreaChange& area = pass.areas[k];
+				text += k == 0 ? L"\n" : L",\n";
+				text += tfm::format(L"        { \"type\": \"%s\", \"file\": \"%s\", \"position\": %d, \"oldSize\": %s, \"newSize\": %s, \"oldUsage\": %s, \"newUsage\": %s }",
+					Allocations::getTypeName(area.type),escapeJsonString(area.fileName),area.position,
+					formatTraceJsonValue(area.oldSpace),formatTraceJsonValue(area.newSpace),
+					formatTraceJsonValue(area.oldUsage),formatTraceJsonValue(area.newUsage));
+			}
+			text += pass.areas.empty() ? L"]" : L"\n      ]";
+
+			text += L"\n    }";
+			continue;
+		}
+
+		text += tfm::format(L"pass %d: %d changed commands%s\n",pass.number,pass.commands.size(),
+			pass.revalidate ? L"" : L", done");
+
+		if (listCommands)
+		{
+			for (const auto& command: pass.commands)
+				text += tfm::format(L"  command %s line %d\n",Global.fileList.relativeWstring(command.first),command.second);
+		}
+
+		for (const LabelChange& label: pass.labels)
+		{
+			text += tfm::format(L"  label   %s %s -> %llX\n",label.name,
+				label.wasDefined ? tfm::format(L"%llX",label.oldValue) : std::wstring(L"undefined"),label.newValue);
+		}
+
+		for (const AreaChange& area: pass.areas)
+		{
+			text += tfm::format(L"  %-7s %s %08llX  size %s -> %s  used %s -> %s\n",Allocations::getTypeName(area.type),
+				area.fileName,area.position,formatTraceValue(area.oldSpace),formatTraceValue(area.newSpace),
+				formatTraceValue(area.oldUsage),formatTraceValue(area.newUsage));
+		}
+	}
+
+	if (json)
+		text += L"\n  ]\n}\n";
+
+	std::string data = convertWStringToUtf8(text);
+
+	fs::ofstream stream(fileName, fs::ofstream::out | fs::ofstream::binary | fs::ofstream::trunc);
+	if (!stream.is_open())
+		return false;
+
+	stream.write(data.data(),data.size());
+	return !stream.fail();
+}
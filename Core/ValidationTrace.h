@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Core/Allocations.h"
+#include "Util/FileSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Records what changed in each validation pass: the commands that requested
+// another pass, the labels that changed their value and the areas, regions
+// and pools that changed their size or usage. Recording only happens while
+// enabled, otherwise every hook is a single branch.
+class ValidationTrace
+{
+public:
+	static void setEnabled(bool state);
+	static bool isEnabled() { return enabled; }
+
+	// only the innermost command is recorded, so a sequence doesn't repeat
+	// the command that caused it to request another pass
+	static size_t getChangeCount() { return changeCount; }
+	static void commandChanged(int fileNum, int line, size_t previousChangeCount)
+	{
+		if (enabled && fileNum >= 0 && changeCount == previousChangeCount)
+			addCommand(fileNum,line);
+	}
+
+	static void endPass(int number, bool revalidate);
+	static bool write(const fs::path& fileName);
+private:
+	struct LabelChange
+	{
+		std::wstring name;
+		bool wasDefined;
+		int64_t oldValue;
+		int64_t newValue;
+	};
+
+	struct AreaChange
+	{
+		AllocationMapEntry::Type type;
+		std::wstring fileName;
+		int64_t position;
+		int64_t oldSpace;
+		int64_t newSpace;
+		int64_t oldUsage;
+		int64_t newUsage;
+	};
+
+	struct Pass
+	{
+		int number;
+		bool revalidate;
+		std::vector<std::pair<int,int>> commands;
+		std::vector<LabelChange> labels;
+		std::vector<AreaChange> areas;
+	};
+
+	struct LabelState
+	{
+		bool defined;
+		int64_t value;
+	};
+
+	typedef std::pair<int64_t,int64_t> AreaKey;
+
+	static void addCommand(int fileNum, int line);
+	static void collectLabelChanges(Pass& pass);
+	static void collectAreaChanges(Pass& pass);
+
+	static bool enabled;
+	static size_t changeCount;
+	static std::vector<std::pair<int,int>> currentCommands;
+	static std::vector<LabelState> labelStates;
+	static std::map<AreaKey,AllocationMapEntry> areaStates;
+	static std::vector<Pass> passes;
+};
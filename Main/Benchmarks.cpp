@@ -0,0 +1,312 @@
+#include "Main/Benchmarks.h"
+
+#include "Core/Assembler.h"
+#include "Core/Common.h"
+#include "Core/Expression.h"
+#include "Core/FileManager.h"
+#include "Core/Misc.h"
+#include "Core/SymbolTable.h"
+#include "Parser/ExpressionParser.h"
+#include "Parser/Tokenizer.h"
+#include "Util/CRC.h"
+#include "Util/EncodingTable.h"
+#include "Util/FileClasses.h"
+#include "Util/Util.h"
+
+#include <chrono>
+#include <functional>
+
+namespace
+{
+	// minimum run time of a benchmark, the iteration count is doubled until
+	// one batch takes at least this long
+	const double minimumTime = 200000000.0;
+
+	volatile uint64_t benchmarkSink;
+
+	// discards all data, only used to measure the FileManager write path
+	class BenchmarkFile: public AssemblerFile
+	{
+	public:
+		bool open(bool onlyCheck) override { opened = !onlyCheck; position = 0; return true; }
+		void close() override { opened = false; }
+		bool isOpen() override { return opened; }
+		bool write(void* data, size_t length) override
+		{
+			benchmarkSink += *(uint8_t*)data;
+			position += length;
+			return true;
+		}
+		int64_t getVirtualAddress() override { return position; }
+		int64_t getPhysicalAddress() override { return position; }
+		int64_t getHeaderSize() override { return 0; }
+		bool seekVirtual(int64_t virtualAddress) override { position = virtualAddress; return true; }
+		bool seekPhysical(int64_t physicalAddress) override { position = physicalAddress; return true; }
+		const fs::path& getFileName() override { return fileName; }
+	private:
+		bool opened = false;
+		int64_t position = 0;
+		fs::path fileName;
+	};
+
+	std::wstring generateSource(size_t lines)
+	{
+		std::wstring result;
+		for (size_t i = 0; i < lines; i++)
+		{
+			result += tfm::format(L"label_%d:\n",i);
+			result += tfm::format(L"\tlw\ta0,0x%X(sp)\t; load\n",(i*4) & 0x7FFF);
+			result += tfm::format(L"\taddiu\tv0,v0,%d\n",i % 1000);
+			result += tfm::format(L"\t.word\tlabel_%d + 4*%d, 0x%08X\n",i,i % 16,i*0x10001);
+			result += tfm::format(L"\t.ascii\t\"text %d\"\n",i);
+		}
+		return result;
+	}
+
+	std::vector<Token> tokenize(const std::wstring& text)
+	{
+		TextFile input;
+		input.openMemory(text);
+
+		FileTokenizer tokenizer;
+		tokenizer.init(&input);
+
+		std::vector<Token> tokens;
+		while (!tokenizer.atEnd())
+			tokens.push_back(tokenizer.nextToken());
+		return tokens;
+	}
+
+	bool matchesFilter(const std::wstring& name, const std::wstring& filter)
+	{
+		return filter.empty() || name.find(filter) != std::wstring::npos;
+	}
+
+	void runBenchmark(const std::wstring& name, const std::wstring& filter, size_t bytesPerOperation,
+		const std::function<void()>& operation)
+	{
+		if (!matchesFilter(name,filter))
+			return;
+
+		using Clock = std::chrono::steady_clock;
+
+		// warm up caches once before measuring
+		operation();
+
+		size_t iterations = 1;
+		while (true)
+		{
+			auto start = Clock::now();
+			for (size_t i = 0; i < iterations; i++)
+				operation();
+			double elapsed = std::chrono::duration<double,std::nano>(Clock::now()-start).count();
+
+			if (elapsed >= minimumTime || iterations >= (size_t(1) << 40))
+			{
+				double nsPerOperation = elapsed/iterations;
+				if (bytesPerOperation != 0)
+				{
+					double megabytesPerSecond = (bytesPerOperation*1000.0/nsPerOperation);
+					Logger::printLine(L"%-28s %12d %14.2f %10.2f",name,iterations,nsPerOperation,megabytesPerSecond);
+				} else {
+					Logger::printLine(L"%-28s %12d %14.2f %10s",name,iterations,nsPerOperation,L"-");
+				}
+				return;
+			}
+
+			iterations *= 2;
+		}
+	}
+
+	void benchmarkTokenizer(const std::wstring& filter)
+	{
+		std::wstring source = generateSource(1000);
+
+		runBenchmark(L"tokenizer.lex",filter,source.size()*sizeof(wchar_t),[&]()
+		{
+			TextFile input;
+			input.openMemory(source);
+
+			FileTokenizer tokenizer;
+			tokenizer.init(&input);
+			benchmarkSink += tokenizer.atEnd();
+		});
+	}
+
+	void benchmarkExpressions(const std::wstring& filter)
+	{
+		const std::wstring expressionText = L"((label_1 + 4*(label_2 - label_1)) >> 2) | 0x80000000";
+
+		Global.symbolTable.clear();
+		for (const wchar_t* name: { L"label_1", L"label_2" })
+		{
+			std::shared_ptr<Label> label = Global.symbolTable.getLabel(name,0,0);
+			label->setValue(0x08000000);
+			label->setDefined(true);
+		}
+
+		TokenStreamTokenizer tokenizer;
+		tokenizer.init(tokenize(expressionText));
+		TokenizerPosition start = tokenizer.getPosition();
+
+		runBenchmark(L"expression.parse",filter,0,[&]()
+		{
+			tokenizer.setPosition(start);
+			Expression exp = parseExpression(tokenizer,false);
+			benchmarkSink += exp.isLoaded();
+		});
+
+		tokenizer.setPosition(start);
+		Expression exp = parseExpression(tokenizer,false);
+
+		runBenchmark(L"expression.evaluate",filter,0,[&]()
+		{
+			benchmarkSink += exp.evaluate().intValue;
+		});
+
+		Global.symbolTable.clear();
+	}
+
+	void benchmarkSymbolTable(const std::wstring& filter)
+	{
+		const size_t count = 10000;
+
+		std::vector<std::wstring> names;
+		for (size_t i = 0; i < count; i++)
+			names.push_back(tfm::format(L"label_%d",i));
+
+		Global.symbolTable.clear();
+		for (size_t i = 0; i < count; i++)
+		{
+			Global.symbolTable.getLabel(names[i],0,0);
+			Global.symbolTable.addEquation(tfm::format(L"equ_%d",i),0,0,i);
+		}
+
+		std::vector<std::wstring> equationNames;
+		for (size_t i = 0; i < count; i++)
+			equationNames.push_back(tfm::format(L"equ_%d",i));
+
+		size_t index = 0;
+		runBenchmark(L"symboltable.getlabel",filter,0,[&]()
+		{
+			benchmarkSink += Global.symbolTable.getLabel(names[index],0,0) != nullptr;
+			index = (index+7919) % count;
+		});
+
+		runBenchmark(L"symboltable.findequation",filter,0,[&]()
+		{
+			size_t dest;
+			benchmarkSink += Global.symbolTable.findEquation(equationNames[index],0,0,dest);
+			index = (index+7919) % count;
+		});
+
+		Global.symbolTable.clear();
+	}
+
+	void benchmarkTrie(const std::wstring& filter)
+	{
+		Trie trie;
+		for (wchar_t c = 0x20; c < 0x7F; c++)
+			trie.insert(c,c);
+
+		const wchar_t* words[] = { L"the", L"then", L"there", L"and", L"ing", L"tion", L"[END]", L"[NAME]" };
+		for (size_t i = 0; i < sizeof(words)/sizeof(words[0]); i++)
+			trie.insert(words[i],0x100+i);
+
+		std::wstring text;
+		while (text.size() < 4096)
+			text += L"Then there was the [NAME] and nothing happening in the station.[END]";
+
+		runBenchmark(L"trie.findlongestprefix",filter,text.size()*sizeof(wchar_t),[&]()
+		{
+			size_t result;
+			for (size_t pos = 0; pos < text.size(); pos++)
+			{
+				if (trie.findLongestPrefix(text.c_str()+pos,result))
+					benchmarkSink += result;
+			}
+		});
+	}
+
+	void benchmarkCrc(const std::wstring& filter)
+	{
+		std::vector<unsigned char> data(65536);
+		for (size_t i = 0; i < data.size(); i++)
+			data[i] = (unsigned char) (i*31+7);
+
+		runBenchmark(L"crc32",filter,data.size(),[&]()
+		{
+			benchmarkSink += getCrc32(data.data(),data.size());
+		});
+	}
+
+	void benchmarkSwapEndianness(const std::wstring& filter)
+	{
+		std::vector<uint8_t> data(65536);
+		for (size_t i = 0; i < data.size(); i++)
+			data[i] = (uint8_t) i;
+
+		for (size_t unitSize: { 2, 4, 8 })
+		{
+			runBenchmark(tfm::format(L"swapendianness%d",unitSize*8),filter,data.size(),[&]()
+			{
+				swapEndianness(data.data(),data.size(),unitSize);
+				benchmarkSink += data[0];
+			});
+		}
+	}
+
+	void benchmarkWrite(const std::wstring& filter)
+	{
+		FileManager fileManager;
+		fileManager.openFile(std::make_shared<BenchmarkFile>(),false);
+
+		for (Endianness endianness: { Endianness::Little, Endianness::Big })
+		{
+			fileManager.setEndianness(endianness);
+
+			const size_t count = 1024;
+			std::wstring name = endianness == Endianness::Little ? L"filemanager.writeu32.le" : L"filemanager.writeu32.be";
+			runBenchmark(name,filter,count*4,[&]()
+			{
+				for (size_t i = 0; i < count; i++)
+					fileManager.writeU32((uint32_t) i);
+			});
+		}
+
+		fileManager.closeFile();
+	}
+
+	void benchmarkSession(const std::wstring& filter)
+	{
+		if (!matchesFilter(L"session.assemble",filter))
+			return;
+
+		AssemblerSession session;
+		if (!session.initialize(L".psx\nbase equ 0x80010000\n.definelabel func, 0x80020000"))
+			return;
+
+		ByteArray output;
+		runBenchmark(L"session.assemble",filter,0,[&]()
+		{
+			session.assemble(L"lui a0,hi(base)\njal func\naddiu a0,a0,lo(base)",0x80030000,output);
+			benchmarkSink += output.size();
+		});
+	}
+}
+
+bool runBenchmarks(const std::wstring& filter)
+{
+	Logger::printLine(L"%-28s %12s %14s %10s",L"benchmark",L"iterations",L"ns/op",L"MB/s");
+
+	benchmarkTokenizer(filter);
+	benchmarkExpressions(filter);
+	benchmarkSymbolTable(filter);
+	benchmarkTrie(filter);
+	benchmarkCrc(filter);
+	benchmarkSwapEndianness(filter);
+	benchmarkWrite(filter);
+	benchmarkSession(filter);
+
+	return !Logger::hasError();
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// Runs the microbenchmarks whose name contains filter and prints one line per
+// benchmark: name, iterations, nanoseconds per operation and throughput
+bool runBenchmarks(const std::wstring& filter);
@@ -17,12 +17,23 @@ static void printUsage(std::wstring executableName)
 	Logger::printLine(L" -temp <TEMP>              Output temporary assembly data to <TEMP> file");
 	Logger::printLine(L" -sym  <SYM>               Output symbol data in the sym format to <SYM> file");
 	Logger::printLine(L" -sym2 <SYM2>              Output symbol data in the sym2 format to <SYM2> file");
+	Logger::printLine(L" -dep  <DEP>               Output Makefile dependencies of all used files to <DEP> file");
+	Logger::printLine(L" -prelude <PRE>            Load macros, equs, labels and table from <PRE> prelude file");
+	Logger::printLine(L" -saveprelude <PRE>        Save macros, equs, labels and table to <PRE> prelude file");
+	Logger::printLine(L" -freemap <MAP>            Output all areas, regions and their free space to <MAP> file");
+	Logger::printLine(L" -compresscache <DIR>      Keep compressed data of .compress directives in <DIR>");
+	Logger::printLine(L" -resultcache <DIR>        Restore all outputs from <DIR> if no input file changed");
 	Logger::printLine(L" -root <ROOT>              Use <ROOT> as working directory during execution");
 	Logger::printLine(L" -equ  <NAME> <VAL>        Equivalent to \'<NAME> equ <VAL>\' in code");
 	Logger::printLine(L" -strequ <NAME> <VAL>      Equivalent to \'<NAME> equ \"<VAL>\"\' in code");
 	Logger::printLine(L" -definelabel <NAME> <VAL> Equivalent to \'.definelabel <NAME>, <VAL>\' in code");
 	Logger::printLine(L" -erroronwarning           Treat all warnings like errors");
+	Logger::printLine(L" -skipunchanged            Don't rewrite output files whose content didn't change");
+	Logger::printLine(L" -dryrun                   Print size and checksum of all output files instead of writing them");
 	Logger::printLine(L" -stat                     Show area usage statistics");
+	Logger::printLine(L" -profile <N>              Show the <N> most expensive source lines, files and macros");
+	Logger::printLine(L" -validationtrace <FILE>   Output the changes of each validation pass to <FILE>");
+	Logger::printLine(L" -threads <N>              Use <N> threads, 0 uses all hardware threads");
 	Logger::printLine(L"");
 	Logger::printLine(L"File arguments:");
 	Logger::printLine(L" <FILE>                    Main assembly code file");
@@ -58,16 +69,85 @@ static bool parseArguments(const std::vector<std::wstring>& arguments, ArmipsArg
 				settings.symFileVersion = 2;
 				argpos += 2;
 			}
+			else if (arguments[argpos] == L"-dep" && argpos + 1 < arguments.size())
+			{
+				settings.dependencyFileName = arguments[argpos + 1];
+				argpos += 2;
+			}
+			else if (arguments[argpos] == L"-freemap" && argpos + 1 < arguments.size())
+			{
+				settings.freeMapFileName = arguments[argpos + 1];
+				argpos += 2;
+			}
+			else if (arguments[argpos] == L"-compresscache" && argpos + 1 < arguments.size())
+			{
+				settings.compressionCacheDirectory = arguments[argpos + 1];
+				argpos += 2;
+			}
+			else if (arguments[argpos] == L"-resultcache" && argpos + 1 < arguments.size())
+			{
+				settings.resultCacheDirectory = arguments[argpos + 1];
+				argpos += 2;
+			}
+			else if (arguments[argpos] == L"-prelude" && argpos + 1 < arguments.size())
+			{
+				settings.preludeFileName = arguments[argpos + 1];
+				argpos += 2;
+			}
+			else if (arguments[argpos] == L"-saveprelude" && argpos + 1 < arguments.size())
+			{
+				settings.savePreludeFileName = arguments[argpos + 1];
+				argpos += 2;
+			}
 			else if (arguments[argpos] == L"-erroronwarning")
 			{
 				settings.errorOnWarning = true;
 				argpos += 1;
 			}
+			else if (arguments[argpos] == L"-skipunchanged")
+			{
+				settings.skipUnchangedOutputs = true;
+				argpos += 1;
+			}
+			else if (arguments[argpos] == L"-dryrun")
+			{
+				settings.dryRun = true;
+				argpos += 1;
+			}
 			else if (arguments[argpos] == L"-stat")
 			{
 				settings.showStats = true;
 				argpos += 1;
 			}
+			else if (arguments[argpos] == L"-profile" && argpos + 1 < arguments.size())
+			{
+				int64_t value;
+				if (!stringToInt(arguments[argpos + 1], 0, arguments[argpos + 1].size(), value) || value <= 0)
+				{
+					Logger::printError(Logger::Error, L"Invalid profile count \"%s\"", arguments[argpos + 1]);
+					return false;
+				}
+
+				settings.profileCount = (size_t) value;
+				argpos += 2;
+			}
+			else if (arguments[argpos] == L"-validationtrace" && argpos + 1 < arguments.size())
+			{
+				settings.validationTraceFileName = arguments[argpos + 1];
+				argpos += 2;
+			}
+			else if (arguments[argpos] == L"-threads" && argpos + 1 < arguments.size())
+			{
+				int64_t value;
+				if (!stringToInt(arguments[argpos + 1], 0, arguments[argpos + 1].size(), value) || value < 0)
+				{
+					Logger::printError(Logger::Error, L"Invalid thread count \"%s\"", arguments[argpos + 1]);
+					return false;
+				}
+
+				settings.threadCount = (size_t) value;
+				argpos += 2;
+			}
 			else if (arguments[argpos] == L"-equ" && argpos + 2 < arguments.size())
 			{
 				EquationDefinition def;
@@ -201,9 +281,9 @@ static bool parseArguments(const std::vector<std::wstring>& arguments, ArmipsArg
 
 	// turn input filename into an absolute path
 	if (settings.useAbsoluteFileNames)
-		settings.inputFileName = fs::absolute(settings.inputFileName).lexically_normal();
+		settings.inputFileName = fs::absolute(settings.workingDirectory / settings.inputFileName).lexically_normal();
 
-	if (!fs::exists(settings.inputFileName))
+	if (!fs::exists(settings.workingDirectory / settings.inputFileName))
 	{
 		Logger::printError(Logger::Error, L"File \"%s\" not found", settings.inputFileName);
 		return false;
@@ -8,6 +8,7 @@
 #include "Util/Util.h"
 
 #include <cstring>
+#include <map>
 
 #ifndef _WIN32
 #include <dirent.h>
@@ -143,23 +144,81 @@ std::vector<std::wstring> TestRunner::getTestsList(const std::wstring& dir, cons
 	return tests;
 }
 
+// assembles each snippet of snippets.asm in one session, with the test file
+// as setup code. snippets are separated by lines starting with ;---
+void TestRunner::runSession(const fs::path& directory, const std::wstring& testName, std::vector<std::wstring>& errors, ByteArray& output)
+{
+	TextFile setupFile;
+	setupFile.open(directory / (testName + L".asm"), TextFile::Read);
+	std::vector<std::wstring> setupLines = setupFile.readAll();
+	setupFile.close();
+
+	TextFile snippetFile;
+	snippetFile.open(directory / "snippets.asm", TextFile::Read);
+	std::vector<std::wstring> snippetLines = snippetFile.readAll();
+	snippetFile.close();
+
+	std::wstring setupCode;
+	for (const std::wstring& line: setupLines)
+		setupCode += line + L"\n";
+
+	std::vector<std::wstring> snippets(1);
+	for (const std::wstring& line: snippetLines)
+	{
+		if (line.compare(0,4,L";---") == 0)
+			snippets.emplace_back();
+		else
+			snippets.back() += line + L"\n";
+	}
+
+	AssemblerSession session;
+	if (!session.initialize(setupCode))
+	{
+		errors = session.getErrors();
+		return;
+	}
+
+	for (const std::wstring& snippet: snippets)
+	{
+		ByteArray snippetOutput;
+		session.assemble(snippet,0,snippetOutput);
+
+		const std::vector<std::wstring>& snippetErrors = session.getErrors();
+		errors.insert(errors.end(),snippetErrors.begin(),snippetErrors.end());
+		output.append(snippetOutput);
+	}
+}
+
 bool TestRunner::executeTest(const std::wstring& dir, const std::wstring& testName, std::wstring& errorString)
 {
+	fs::path directory = fs::absolute(dir).lexically_normal();
 	fs::path oldDir = fs::current_path();
-	fs::current_path(dir);
 
 	ArmipsArguments settings;
 	std::vector<std::wstring> errors;
+	std::map<fs::path,ByteArray> outputs;
 	int expectedRetVal = 0;
 	int retVal = 0;
 	bool checkRetVal = false;
+	bool session = fs::exists(directory / "snippets.asm");
+	bool checkDryRun = fs::exists(directory / "expecteddryrun.txt");
+	std::vector<std::wstring> dryRunSummary;
 	bool result = true;
 	std::vector<std::wstring> args;
 
-	if (fs::exists("commandLine.txt"))
+	if (inMemory)
+	{
+		settings.workingDirectory = directory;
+		settings.dryRun = true;
+		settings.outputsResult = &outputs;
+	} else {
+		fs::current_path(directory);
+	}
+
+	if (fs::exists(directory / "commandLine.txt"))
 	{
 		TextFile f;
-		f.open("commandLine.txt", TextFile::Read);
+		f.open(directory / "commandLine.txt", TextFile::Read);
 		std::wstring command = f.readLine();
 		f.close();
 		
@@ -173,7 +232,15 @@ bool TestRunner::executeTest(const std::wstring& dir, const std::wstring& testNa
 	else
 	{
 		settings.inputFileName = testName + L".asm";
-		settings.tempFileName = testName + L".temp.txt";
+		if (!inMemory)
+			settings.tempFileName = testName + L".temp.txt";
+	}
+
+	// compare the printed summary instead of writing the outputs
+	if (checkDryRun)
+	{
+		settings.dryRun = true;
+		settings.dryRunResult = &dryRunSummary;
 	}
 
 	settings.errorsResult = &errors;
@@ -181,7 +248,15 @@ bool TestRunner::executeTest(const std::wstring& dir, const std::wstring& testNa
 	settings.useAbsoluteFileNames = false;
 
 	// may or may not be supposed to cause errors
-	retVal = runFromCommandLine(args, settings);
+	if (session)
+	{
+		ByteArray& output = outputs[directory / "output.bin"];
+		runSession(directory,testName,errors,output);
+		if (!inMemory)
+			output.toFile("output.bin");
+	} else {
+		retVal = runFromCommandLine(args, settings);
+	}
 
 	if (checkRetVal && retVal != expectedRetVal)
 	{
@@ -190,10 +265,10 @@ bool TestRunner::executeTest(const std::wstring& dir, const std::wstring& testNa
 	}
 
 	// check errors
-	if (fs::exists("expected.txt"))
+	if (fs::exists(directory / "expected.txt"))
 	{
 		TextFile f;
-		f.open("expected.txt", TextFile::Read);
+		f.open(directory / "expected.txt", TextFile::Read);
 		std::vector<std::wstring> expectedErrors = f.readAll();
 
 		if (errors.size() == expectedErrors.size())
@@ -219,15 +294,41 @@ bool TestRunner::executeTest(const std::wstring& dir, const std::wstring& testNa
 	}
 
 	// write errors to file
-	TextFile output;
-	output.open("output.txt", TextFile::Write);
-	output.writeLines(errors);
-	output.close();
+	if (!inMemory)
+	{
+		TextFile output;
+		output.open("output.txt", TextFile::Write);
+		output.writeLines(errors);
+		output.close();
+	}
+
+	if (checkDryRun)
+	{
+		TextFile f;
+		f.open(directory / "expecteddryrun.txt", TextFile::Read);
+		std::vector<std::wstring> expectedSummary = f.readAll();
+		f.close();
 
-	if (fs::exists("expected.bin"))
+		if (dryRunSummary != expectedSummary)
+		{
+			errorString += tfm::format(L"Dry run summary does not match\n");
+			result = false;
+		}
+	}
+
+	if (fs::exists(directory / "expected.bin"))
 	{
-		ByteArray expected = ByteArray::fromFile("expected.bin");
-		ByteArray actual = ByteArray::fromFile("output.bin");
+		ByteArray expected = ByteArray::fromFile(directory / "expected.bin");
+		ByteArray actual;
+
+		if (inMemory || session)
+		{
+			auto it = outputs.find(directory / "output.bin");
+			if (it != outputs.end())
+				actual = std::move(it->second);
+		} else {
+			actual = ByteArray::fromFile("output.bin");
+		}
 
 		if (expected.size() == actual.size())
 		{
@@ -242,13 +343,15 @@ bool TestRunner::executeTest(const std::wstring& dir, const std::wstring& testNa
 		}
 	}
 
-	fs::current_path(oldDir);
+	if (!inMemory)
+		fs::current_path(oldDir);
 	return result;
 }
 
-bool TestRunner::runTests(const std::wstring& dir, const std::wstring& executableName)
+bool TestRunner::runTests(const std::wstring& dir, const std::wstring& executableName, bool inMemory)
 {
 	this->executableName = executableName;
+	this->inMemory = inMemory;
 
 	std::vector<std::wstring> tests = getTestsList(dir);
 	if (tests.empty())
@@ -291,8 +394,8 @@ bool TestRunner::runTests(const std::wstring& dir, const std::wstring& executabl
 	return successCount == tests.size();
 }
 
-bool runTests(const std::wstring& dir, const std::wstring& executableName)
+bool runTests(const std::wstring& dir, const std::wstring& executableName, bool inMemory)
 {
 	TestRunner runner;
-	return runner.runTests(dir, executableName);
+	return runner.runTests(dir, executableName, inMemory);
 }
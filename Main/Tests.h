@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Util/ByteArray.h"
+#include "Util/FileSystem.h"
+
 #include <string>
 #include <vector>
 
@@ -14,14 +17,17 @@
 class TestRunner
 {
 public:
-	bool runTests(const std::wstring& dir, const std::wstring& executableName);
+	bool runTests(const std::wstring& dir, const std::wstring& executableName, bool inMemory);
 private:
 	enum class ConsoleColors { White, Red, Green };
 
 	std::wstring executableName;
+	// assemble with dry runs, without changing the current directory or writing files
+	bool inMemory;
 	
 	std::vector<std::wstring> getTestsList(const std::wstring& dir, const std::wstring& prefix = L"/");
 	bool executeTest(const std::wstring& dir, const std::wstring& testName, std::wstring& errorString);
+	void runSession(const fs::path& directory, const std::wstring& testName, std::vector<std::wstring>& errors, ByteArray& output);
 	std::vector<std::wstring> listSubfolders(const std::wstring& dir);
 	void initConsole();
 	void changeConsoleColor(ConsoleColors color);
@@ -35,4 +41,4 @@ private:
 
 };
 
-bool runTests(const std::wstring& dir, const std::wstring& executableName);
+bool runTests(const std::wstring& dir, const std::wstring& executableName, bool inMemory);
@@ -2,6 +2,7 @@
 #include "Archs/MIPS/Mips.h"
 #include "Commands/CDirectiveFile.h"
 #include "Core/Assembler.h"
+#include "Main/Benchmarks.h"
 #include "Main/CommandLineInterface.h"
 #include "Main/Tests.h"
 #include "Util/Util.h"
@@ -15,10 +16,23 @@ int wmain(int argc, wchar_t* argv[])
 #ifdef ARMIPS_TESTS
 	std::wstring name;
 
-	if (argc < 2)
-		return !runTests(L"Tests", argv[0]);
+	// -memory runs the tests without writing any files
+	int argpos = 1;
+	bool inMemory = false;
+	if (argc > argpos && std::wstring(argv[argpos]) == L"-memory")
+	{
+		inMemory = true;
+		argpos++;
+	}
+
+	if (argc <= argpos)
+		return !runTests(L"Tests", argv[0], inMemory);
 	else
-		return !runTests(argv[1], argv[0]);
+		return !runTests(argv[argpos], argv[0], inMemory);
+#endif
+
+#ifdef ARMIPS_BENCHMARKS
+	return !runBenchmarks(argc < 2 ? L"" : argv[1]);
 #endif
 
 	std::vector<std::wstring> arguments = getStringListFromArray(argv,argc);
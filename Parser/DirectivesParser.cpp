@@ -9,6 +9,7 @@
 #include "Commands/CDirectiveFile.h"
 #include "Commands/CDirectiveMessage.h"
 #include "Commands/CommandSequence.h"
+#include "Core/Allocations.h"
 #include "Core/Common.h"
 #include "Core/Expression.h"
 #include "Core/Misc.h"
@@ -97,6 +98,49 @@ std::unique_ptr<CAssemblerCommand> parseDirectiveIncbin(Parser& parser, int flag
 	return incbin;
 }
 
+std::unique_ptr<CAssemblerCommand> parseDirectiveCompress(Parser& parser, int flags)
+{
+	const Token& start = parser.peekToken();
+
+	std::vector<Expression> list;
+	CompressionType type = CompressionType::Lz10;
+	if (flags & DIRECTIVE_COMPRESS_TYPE)
+	{
+		if (!parser.parseExpressionList(list,2,4))
+			return nullptr;
+
+		std::wstring typeName;
+		if (!list[0].evaluateIdentifier(typeName))
+			return nullptr;
+
+		std::transform(typeName.begin(),typeName.end(),typeName.begin(),::towlower);
+		if (!parseCompressionType(typeName,type))
+		{
+			parser.printError(start,L"Unknown compression type %s",typeName);
+			return nullptr;
+		}
+
+		list.erase(list.begin());
+	} else {
+		if (!parser.parseExpressionList(list,1,3))
+			return nullptr;
+	}
+
+	std::wstring fileName;
+	if (!list[0].evaluateString(fileName,false))
+		return nullptr;
+
+	auto incbin = std::make_unique<CDirectiveIncbin>(fileName);
+	if (list.size() >= 2)
+		incbin->setStart(list[1]);
+
+	if (list.size() == 3)
+		incbin->setSize(list[2]);
+
+	incbin->setCompression(type);
+	return incbin;
+}
+
 std::unique_ptr<CAssemblerCommand> parseDirectivePosition(Parser& parser, int flags)
 {
 	Expression exp = parser.parseExpression();
@@ -500,6 +544,29 @@ std::unique_ptr<CAssemblerCommand> parseDirectiveAutoRegion(Parser& parser, int
 	return area;
 }
 
+std::unique_ptr<CAssemblerCommand> parseDirectiveAutoRegionPacking(Parser& parser, int flags)
+{
+	const Token &tok = parser.nextToken();
+
+	if (tok.type != TokenType::Identifier && tok.type != TokenType::String)
+		return nullptr;
+
+	std::wstring stringValue = tok.getStringValue();
+	std::transform(stringValue.begin(),stringValue.end(),stringValue.begin(),::towlower);
+
+	if (stringValue == L"firstfit")
+	{
+		Allocations::setBestFitPacking(false);
+		return std::make_unique<DummyCommand>();
+	} else if (stringValue == L"bestfit")
+	{
+		Allocations::setBestFitPacking(true);
+		return std::make_unique<DummyCommand>();
+	}
+
+	return nullptr;
+}
+
 std::unique_ptr<CAssemblerCommand> parseDirectiveErrorWarning(Parser& parser, int flags)
 {
 	const Token &tok = parser.nextToken();
@@ -712,6 +779,8 @@ const DirectiveMap directives = {
 	{ L".closefile",		{ &parseDirectiveClose,				DIRECTIVE_NOTINMEMORY } },
 	{ L".incbin",			{ &parseDirectiveIncbin,			0 } },
 	{ L".import",			{ &parseDirectiveIncbin,			0 } },
+	{ L".incbin_lz",		{ &parseDirectiveCompress,			0 } },
+	{ L".compress",			{ &parseDirectiveCompress,			DIRECTIVE_COMPRESS_TYPE } },
 	{ L".org",				{ &parseDirectivePosition,			DIRECTIVE_POS_VIRTUAL } },
 	{ L"org",				{ &parseDirectivePosition,			DIRECTIVE_POS_VIRTUAL } },
 	{ L".orga",				{ &parseDirectivePosition,			DIRECTIVE_POS_PHYSICAL } },
@@ -778,6 +847,7 @@ const DirectiveMap directives = {
 	
 	{ L".area",				{ &parseDirectiveArea,				0 } },
 	{ L".autoregion",		{ &parseDirectiveAutoRegion,		0 } },
+	{ L".autoregionpacking",	{ &parseDirectiveAutoRegionPacking,	0 } },
 	{ L".region",			{ &parseDirectiveArea,				DIRECTIVE_AREA_SHARED } },
 	{ L".defineregion",		{ &parseDirectiveDefineArea,		DIRECTIVE_AREA_SHARED } },
 
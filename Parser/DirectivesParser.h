@@ -31,6 +31,7 @@ using DirectiveMap = std::unordered_multimap<std::wstring, const DirectiveEntry>
 #define DIRECTIVE_ALIGN_PHYSICAL	0x00000001
 #define DIRECTIVE_ALIGN_VIRTUAL		0x00000002
 #define DIRECTIVE_ALIGN_FILL		0x00000004
+#define DIRECTIVE_COMPRESS_TYPE		0x00000008
 
 // conditional directive flags
 #define DIRECTIVE_COND_IF			0x00000001
@@ -123,320 +123,64 @@ static ExpressionInternal* unaryExpression(Tokenizer& tokenizer)
 	}
 }
 
-static ExpressionInternal* multiplicativeExpression(Tokenizer& tokenizer)
+struct BinaryOperator
 {
-	ExpressionInternal* exp = unaryExpression(tokenizer);
-	if (exp ==  nullptr)
-		return nullptr;
-
-	while (true)
-	{
-		OperatorType op = OperatorType::Invalid;
-		switch (tokenizer.peekToken().type)
-		{
-		case TokenType::Mult:
-			op = OperatorType::Mult;
-			break;
-		case TokenType::Div:
-			op = OperatorType::Div;
-			break;
-		case TokenType::Mod:
-			op = OperatorType::Mod;
-			break;
-		default:
-			break;
-		}
-
-		if (op == OperatorType::Invalid)
-			break;
-
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = unaryExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(op,exp,exp2);
-	}
-
-	return exp;
-}
+	OperatorType type;
+	int precedence;
+};
 
-static ExpressionInternal* additiveExpression(Tokenizer& tokenizer)
+// binding strength of each binary operator, higher binds tighter. all of
+// them are left associative
+static BinaryOperator binaryOperator(TokenType type)
 {
-	ExpressionInternal* exp = multiplicativeExpression(tokenizer);
-	if (exp == nullptr)
-		return nullptr;
-
-	while (true)
+	switch (type)
 	{
-		OperatorType op = OperatorType::Invalid;
-		switch (tokenizer.peekToken().type)
-		{
-		case TokenType::Plus:
-			op = OperatorType::Add;
-			break;
-		case TokenType::Minus:
-			op = OperatorType::Sub;
-			break;
-		default:
-			break;
-		}
-
-		if (op == OperatorType::Invalid)
-			break;
-
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = multiplicativeExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(op,exp,exp2);
+	case TokenType::Mult:			return { OperatorType::Mult, 10 };
+	case TokenType::Div:			return { OperatorType::Div, 10 };
+	case TokenType::Mod:			return { OperatorType::Mod, 10 };
+	case TokenType::Plus:			return { OperatorType::Add, 9 };
+	case TokenType::Minus:			return { OperatorType::Sub, 9 };
+	case TokenType::LeftShift:		return { OperatorType::LeftShift, 8 };
+	case TokenType::RightShift:		return { OperatorType::RightShift, 8 };
+	case TokenType::Less:			return { OperatorType::Less, 7 };
+	case TokenType::LessEqual:		return { OperatorType::LessEqual, 7 };
+	case TokenType::Greater:		return { OperatorType::Greater, 7 };
+	case TokenType::GreaterEqual:	return { OperatorType::GreaterEqual, 7 };
+	case TokenType::Equal:			return { OperatorType::Equal, 6 };
+	case TokenType::NotEqual:		return { OperatorType::NotEqual, 6 };
+	case TokenType::BitAnd:			return { OperatorType::BitAnd, 5 };
+	case TokenType::Caret:			return { OperatorType::Xor, 4 };
+	case TokenType::BitOr:			return { OperatorType::BitOr, 3 };
+	case TokenType::LogAnd:			return { OperatorType::LogAnd, 2 };
+	case TokenType::LogOr:			return { OperatorType::LogOr, 1 };
+	default:						return { OperatorType::Invalid, 0 };
 	}
-
-	return exp;
 }
 
-static ExpressionInternal* shiftExpression(Tokenizer& tokenizer)
+// precedence climbing: parses all binary operators binding at least as
+// tight as minPrecedence in one loop instead of one function per level
+static ExpressionInternal* binaryExpression(Tokenizer& tokenizer, int minPrecedence)
 {
-	ExpressionInternal* exp = additiveExpression(tokenizer);
-	if (exp == nullptr)
-		return nullptr;
-
-	while (true)
-	{
-		OperatorType op = OperatorType::Invalid;
-		switch (tokenizer.peekToken().type)
-		{
-		case TokenType::LeftShift:
-			op = OperatorType::LeftShift;
-			break;
-		case TokenType::RightShift:
-			op = OperatorType::RightShift;
-			break;
-		default:
-			break;
-		}
-
-		if (op == OperatorType::Invalid)
-			break;
-
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = additiveExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(op,exp,exp2);
-	}
-
-	return exp;
-}
-
-static ExpressionInternal* relationalExpression(Tokenizer& tokenizer)
-{
-	ExpressionInternal* exp = shiftExpression(tokenizer);
-	if (exp == nullptr)
-		return nullptr;
-
-	while (true)
-	{
-		OperatorType op = OperatorType::Invalid;
-		switch (tokenizer.peekToken().type)
-		{
-		case TokenType::Less:
-			op = OperatorType::Less;
-			break;
-		case TokenType::LessEqual:
-			op = OperatorType::LessEqual;
-			break;
-		case TokenType::Greater:
-			op = OperatorType::Greater;
-			break;
-		case TokenType::GreaterEqual:
-			op = OperatorType::GreaterEqual;
-			break;
-		default:
-			break;
-		}
-
-		if (op == OperatorType::Invalid)
-			break;
-
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = shiftExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(op,exp,exp2);
-	}
-
-	return exp;
-}
-
-static ExpressionInternal* equalityExpression(Tokenizer& tokenizer)
-{
-	ExpressionInternal* exp = relationalExpression(tokenizer);
+	ExpressionInternal* exp = unaryExpression(tokenizer);
 	if (exp == nullptr)
 		return nullptr;
 
 	while (true)
 	{
-		OperatorType op = OperatorType::Invalid;
-		switch (tokenizer.peekToken().type)
-		{
-		case TokenType::Equal:
-			op = OperatorType::Equal;
-			break;
-		case TokenType::NotEqual:
-			op = OperatorType::NotEqual;
-			break;
-		default:
+		BinaryOperator op = binaryOperator(tokenizer.peekToken().type);
+		if (op.type == OperatorType::Invalid || op.precedence < minPrecedence)
 			break;
-		}
-
-		if (op == OperatorType::Invalid)
-			break;
-
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = relationalExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(op,exp,exp2);
-	}
-
-	return exp;
-}
-
-static ExpressionInternal* andExpression(Tokenizer& tokenizer)
-{
-	ExpressionInternal* exp = equalityExpression(tokenizer);
-	if (exp == nullptr)
-		return nullptr;
-
-	while (tokenizer.peekToken().type == TokenType::BitAnd)
-	{
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = equalityExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(OperatorType::BitAnd,exp,exp2);
-	}
-
-	return exp;
-}
-
-static ExpressionInternal* exclusiveOrExpression(Tokenizer& tokenizer)
-{
-	ExpressionInternal* exp = andExpression(tokenizer);
-	if (exp == nullptr)
-		return nullptr;
-
-	while (tokenizer.peekToken().type == TokenType::Caret)
-	{
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = andExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(OperatorType::Xor,exp,exp2);
-	}
-
-	return exp;
-}
-
-static ExpressionInternal* inclusiveOrExpression(Tokenizer& tokenizer)
-{
-	ExpressionInternal* exp = exclusiveOrExpression(tokenizer);
-	if (exp == nullptr)
-		return nullptr;
-
-	while (tokenizer.peekToken().type == TokenType::BitOr)
-	{
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = exclusiveOrExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(OperatorType::BitOr,exp,exp2);
-	}
-
-	return exp;
-}
 
-static ExpressionInternal* logicalAndExpression(Tokenizer& tokenizer)
-{
-	ExpressionInternal* exp = inclusiveOrExpression(tokenizer);
-	if (exp == nullptr)
-		return nullptr;
-
-	while (tokenizer.peekToken().type == TokenType::LogAnd)
-	{
-		tokenizer.eatToken();
-
-		ExpressionInternal* exp2 = inclusiveOrExpression(tokenizer);
-		if (exp2 == nullptr)
-		{
-			delete exp;
-			return nullptr;
-		}
-
-		exp = new ExpressionInternal(OperatorType::LogAnd,exp,exp2);
-	}
-
-	return exp;
-}
-
-static ExpressionInternal* logicalOrExpression(Tokenizer& tokenizer)
-{
-	ExpressionInternal* exp = logicalAndExpression(tokenizer);
-	if (exp == nullptr)
-		return nullptr;
-
-	while (tokenizer.peekToken().type == TokenType::LogOr)
-	{
 		tokenizer.eatToken();
 
-		ExpressionInternal* exp2 = logicalAndExpression(tokenizer);
+		ExpressionInternal* exp2 = binaryExpression(tokenizer,op.precedence+1);
 		if (exp2 == nullptr)
 		{
 			delete exp;
 			return nullptr;
 		}
 
-		exp = new ExpressionInternal(OperatorType::LogOr,exp,exp2);
+		exp = new ExpressionInternal(op.type,exp,exp2);
 	}
 
 	return exp;
@@ -444,7 +188,7 @@ static ExpressionInternal* logicalOrExpression(Tokenizer& tokenizer)
 
 static ExpressionInternal* conditionalExpression(Tokenizer& tokenizer)
 {
-	ExpressionInternal* exp = logicalOrExpression(tokenizer);
+	ExpressionInternal* exp = binaryExpression(tokenizer,1);
 	if (exp == nullptr)
 		return nullptr;
 
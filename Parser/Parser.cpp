@@ -7,6 +7,7 @@
 #include "Core/Misc.h"
 #include "Parser/DirectivesParser.h"
 #include "Parser/ExpressionParser.h"
+#include "Util/Profiler.h"
 #include "Util/Util.h"
 
 inline bool isPartOfList(const std::wstring& value, const std::initializer_list<const wchar_t*>& terminators)
@@ -24,6 +25,8 @@ Parser::Parser()
 {
 	initializingMacro = false;
 	overrideFileInfo = false;
+	commandCount = 0;
+	checkpoint.active = false;
 	conditionStack.push_back({true,false});
 	clearError();
 }
@@ -286,6 +289,7 @@ std::unique_ptr<CAssemblerCommand> Parser::parse(Tokenizer* tokenizer, bool virt
 	{
 		entry.fileNum = (int) Global.fileList.size();
 		Global.fileList.add(name);
+		Global.dependencies.addInput(name);
 	} else {
 		entry.fileNum = -1;
 	}
@@ -496,9 +500,28 @@ bool Parser::checkMacroDefinition()
 	}
 
 	macros[macro.name] = macro;
+	if (checkpoint.active)
+		checkpoint.addedMacros.push_back(macro.name);
 	return true;
 }
 
+void Parser::setCheckpoint()
+{
+	checkpoint.active = true;
+	checkpoint.addedMacros.clear();
+}
+
+void Parser::rollback()
+{
+	if (!checkpoint.active)
+		return;
+
+	for (const std::wstring& name: checkpoint.addedMacros)
+		macros.erase(name);
+	checkpoint.addedMacros.clear();
+	macroLabels.clear();
+}
+
 std::unique_ptr<CAssemblerCommand> Parser::parseMacroCall()
 {
 	const Token& start = peekToken();
@@ -583,6 +606,9 @@ std::unique_ptr<CAssemblerCommand> Parser::parseMacroCall()
 	if (initializingMacro)
 		return std::make_unique<DummyCommand>();
 
+	int macroId = Profiler::getMacroId(macro.name);
+	Profiler::MacroScope profileScope(ProfilePhase::Parse,macroId);
+
 	// the first time a macro is instantiated, it needs to be analyzed
 	// for labels
 	if (macro.counter == 0)
@@ -601,7 +627,9 @@ std::unique_ptr<CAssemblerCommand> Parser::parseMacroCall()
 		initializingMacro = false;
 	}
 
-	// register labels and replacements
+	// register labels and replacements. the names only differ in the
+	// instantiation number, so it's formatted once for all labels
+	std::wstring counterSuffix = L"_" + intToHexString((unsigned int) macro.counter,8);
 	for (const std::wstring& label: macro.labels)
 	{
 		// check if the label is using the name of a parameter
@@ -610,13 +638,26 @@ std::unique_ptr<CAssemblerCommand> Parser::parseMacroCall()
 			continue;
 
 		// otherwise make sure the name is unique
+		size_t prefixLength = 0;
+		switch (SymbolTable::getSymbolScope(label))
+		{
+		case SymbolScope::Local:
+			prefixLength = 2;
+			break;
+		case SymbolScope::Static:
+			prefixLength = 1;
+			break;
+		case SymbolScope::Global:
+			break;
+		}
+
 		std::wstring fullName;
-		if (Global.symbolTable.isLocalSymbol(label))
-			fullName = tfm::format(L"@@%s_%s_%08X",macro.name,label.substr(2),macro.counter);
-		else if (Global.symbolTable.isStaticSymbol(label))
-			fullName = tfm::format(L"@%s_%s_%08X",macro.name,label.substr(1),macro.counter);
-		else
-			fullName = tfm::format(L"%s_%s_%08X",macro.name,label,macro.counter);
+		fullName.reserve(label.size()+macro.name.size()+counterSuffix.size()+1);
+		fullName.append(label,0,prefixLength);
+		fullName += macro.name;
+		fullName += L'_';
+		fullName.append(label,prefixLength,std::wstring::npos);
+		fullName += counterSuffix;
 
 		macroTokenizer.registerReplacement(label,fullName);
 	}
@@ -624,7 +665,11 @@ std::unique_ptr<CAssemblerCommand> Parser::parseMacroCall()
 	macroTokenizer.init(macro.content);
 	macro.counter++;
 
-	return parse(&macroTokenizer,true);
+	std::unique_ptr<CAssemblerCommand> sequence = parse(&macroTokenizer,true);
+	if (sequence != nullptr && macroId >= 0)
+		static_cast<CommandSequence*>(sequence.get())->setProfileMacro(macroId);
+
+	return sequence;
 
 }
 
@@ -701,10 +746,12 @@ std::unique_ptr<CAssemblerCommand> Parser::parseCommand()
 	std::unique_ptr<CAssemblerCommand> command;
 
 	updateFileInfo();
+	Profiler::LineScope profileScope(ProfilePhase::Parse,Global.FileInfo.FileNum,Global.FileInfo.LineNumber);
 
 	if (atEnd())
 		return std::make_unique<DummyCommand>();
 
+	commandCount++;
 	if ((command = parseLabel()) != nullptr)
 		return command;
 	if (hasError())
@@ -44,6 +44,13 @@ public:
 	bool atEnd() { return entries.back().tokenizer->atEnd(); }
 
 	void addEquation(const Token& start, const std::wstring& name, const std::wstring& value);
+	const std::map<std::wstring,ParserMacro>& getMacros() const { return macros; }
+	// all parsed commands, including the content of macros and included files
+	size_t getCommandCount() const { return commandCount; }
+	void addMacro(const ParserMacro& macro) { macros[macro.name] = macro; }
+	// rollback removes all macros defined after the checkpoint
+	void setCheckpoint();
+	void rollback();
 
 	Expression parseExpression();
 	bool parseExpressionList(std::vector<Expression>& list, int min = -1, int max = -1);
@@ -98,8 +105,17 @@ protected:
 	std::vector<FileEntry> entries;
 	std::map<std::wstring,ParserMacro> macros;
 	std::set<std::wstring> macroLabels;
+
+	// macros added after the checkpoint, removed again by rollback
+	struct Checkpoint
+	{
+		bool active;
+		std::vector<std::wstring> addedMacros;
+	} checkpoint;
+
 	bool initializingMacro;
 	bool error;
+	size_t commandCount;
 	size_t errorLine;
 
 	bool overrideFileInfo;
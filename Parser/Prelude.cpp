@@ -0,0 +1,289 @@
+#include "Parser/Prelude.h"
+
+#include "Core/Assembler.h"
+#include "Core/Common.h"
+#include "Core/Misc.h"
+#include "Core/SymbolTable.h"
+#include "Parser/Parser.h"
+#include "Parser/Tokenizer.h"
+#include "Util/ByteArray.h"
+#include "Util/EncodingTable.h"
+#include "Util/Util.h"
+
+namespace
+{
+	const uint32_t preludeMagic = 0x4C505241;	// "ARPL"
+	const uint32_t preludeVersion = 1;
+
+	class PreludeWriter
+	{
+	public:
+		void writeU32(uint32_t value)
+		{
+			for (int i = 0; i < 4; i++)
+				data.appendByte((value >> (i*8)) & 0xFF);
+		}
+
+		void writeU64(uint64_t value)
+		{
+			writeU32((uint32_t) value);
+			writeU32((uint32_t) (value >> 32));
+		}
+
+		void writeBytes(const ByteArray& bytes)
+		{
+			writeU32((uint32_t) bytes.size());
+			data.append(bytes);
+		}
+
+		void writeString(const std::wstring& text)
+		{
+			std::string utf8 = convertWStringToUtf8(text);
+			writeU32((uint32_t) utf8.size());
+			data.append((void*) utf8.data(),utf8.size());
+		}
+
+		void writeToken(const Token& token)
+		{
+			writeU32((uint32_t) token.type);
+			writeU64(token.line);
+			writeU64(token.column);
+			writeU64((uint64_t) token.intValue);
+			writeString(token.getOriginalText());
+			writeString(token.getStringValue());
+		}
+
+		void writeTokens(const std::vector<Token>& tokens)
+		{
+			writeU32((uint32_t) tokens.size());
+			for (const Token& token: tokens)
+				writeToken(token);
+		}
+
+		ByteArray data;
+	};
+
+	class PreludeReader
+	{
+	public:
+		PreludeReader(const ByteArray& data): data(data), pos(0), valid(true) { }
+
+		bool isValid() { return valid; }
+		bool atEnd() { return pos == data.size(); }
+
+		uint32_t readU32()
+		{
+			if (!check(4))
+				return 0;
+
+			uint32_t value = (uint32_t) data.getDoubleWord(pos);
+			pos += 4;
+			return value;
+		}
+
+		uint64_t readU64()
+		{
+			uint64_t low = readU32();
+			uint64_t high = readU32();
+			return low | (high << 32);
+		}
+
+		ByteArray readBytes()
+		{
+			size_t size = readU32();
+			if (!check(size))
+				return ByteArray();
+
+			ByteArray result = data.mid(pos,size);
+			pos += size;
+			return result;
+		}
+
+		std::wstring readString()
+		{
+			size_t size = readU32();
+			if (!check(size))
+				return std::wstring();
+
+			std::wstring result = convertUtf8ToWString((const char*) data.data(pos),size);
+			pos += size;
+			return result;
+		}
+
+		Token readToken()
+		{
+			Token token;
+			token.type = (TokenType) readU32();
+			token.line = (size_t) readU64();
+			token.column = (size_t) readU64();
+			token.intValue = (int64_t) readU64();
+			token.setOriginalText(readString());
+			token.setStringValue(readString());
+			return token;
+		}
+
+		std::vector<Token> readTokens()
+		{
+			std::vector<Token> tokens;
+			size_t count = readU32();
+			for (size_t i = 0; i < count && valid; i++)
+				tokens.push_back(readToken());
+			return tokens;
+		}
+	private:
+		bool check(size_t size)
+		{
+			if (pos+size > data.size())
+				valid = false;
+			return valid;
+		}
+
+		const ByteArray& data;
+		size_t pos;
+		bool valid;
+	};
+}
+
+bool savePrelude(const fs::path& fileName, const Parser& parser)
+{
+	PreludeWriter writer;
+	writer.writeU32(preludeMagic);
+	writer.writeU32(preludeVersion);
+
+	// equs
+	std::vector<std::pair<std::wstring,size_t>> equations = Global.symbolTable.getGlobalEquations();
+	writer.writeU32((uint32_t) equations.size());
+	for (const auto& equation: equations)
+	{
+		writer.writeString(equation.first);
+		writer.writeTokens(Tokenizer::getEquValue(equation.second));
+	}
+
+	// labels
+	std::vector<LabelDefinition> labels = Global.symbolTable.getGlobalLabels();
+	writer.writeU32((uint32_t) labels.size());
+	for (const LabelDefinition& label: labels)
+	{
+		writer.writeString(label.name);
+		writer.writeString(label.originalName);
+		writer.writeU64((uint64_t) label.value);
+	}
+
+	// macros
+	const std::map<std::wstring,ParserMacro>& macros = parser.getMacros();
+	writer.writeU32((uint32_t) macros.size());
+	for (const auto& it: macros)
+	{
+		const ParserMacro& macro = it.second;
+		writer.writeString(macro.name);
+
+		writer.writeU32((uint32_t) macro.parameters.size());
+		for (const std::wstring& parameter: macro.parameters)
+			writer.writeString(parameter);
+
+		writer.writeU32((uint32_t) macro.labels.size());
+		for (const std::wstring& label: macro.labels)
+			writer.writeString(label);
+
+		writer.writeTokens(macro.content);
+		writer.writeU64(macro.counter);
+	}
+
+	// encoding table
+	writer.writeU32(Global.Table.isLoaded() ? 1 : 0);
+	if (Global.Table.isLoaded())
+	{
+		writer.writeBytes(Global.Table.getTerminationHex());
+		writer.writeU32((uint32_t) Global.Table.getEntryCount());
+		for (size_t i = 0; i < Global.Table.getEntryCount(); i++)
+		{
+			writer.writeBytes(Global.Table.getEntryHex(i));
+			writer.writeString(Global.Table.getEntryValue(i));
+		}
+	}
+
+	return writer.data.toFile(fileName);
+}
+
+bool loadPrelude(const fs::path& fileName, Parser& parser, std::vector<LabelDefinition>& labels)
+{
+	if (!fs::exists(fileName))
+	{
+		Logger::printError(Logger::Error,L"Could not open prelude %s",fileName.wstring());
+		return false;
+	}
+
+	ByteArray data = ByteArray::fromFile(fileName);
+	PreludeReader reader(data);
+
+	if (reader.readU32() != preludeMagic || reader.readU32() != preludeVersion)
+	{
+		Logger::printError(Logger::Error,L"Invalid prelude %s",fileName.wstring());
+		return false;
+	}
+
+	// equs
+	size_t equationCount = reader.readU32();
+	for (size_t i = 0; i < equationCount && reader.isValid(); i++)
+	{
+		std::wstring name = reader.readString();
+		size_t index = Tokenizer::addEquValue(reader.readTokens());
+		if (!Global.symbolTable.addEquation(name,-1,-1,index))
+			Logger::printError(Logger::Error,L"Equation name %s already defined",name);
+	}
+
+	// labels
+	size_t labelCount = reader.readU32();
+	for (size_t i = 0; i < labelCount && reader.isValid(); i++)
+	{
+		LabelDefinition label;
+		label.name = reader.readString();
+		label.originalName = reader.readString();
+		label.value = (int64_t) reader.readU64();
+		labels.push_back(label);
+	}
+
+	// macros
+	size_t macroCount = reader.readU32();
+	for (size_t i = 0; i < macroCount && reader.isValid(); i++)
+	{
+		ParserMacro macro;
+		macro.name = reader.readString();
+
+		size_t parameterCount = reader.readU32();
+		for (size_t k = 0; k < parameterCount && reader.isValid(); k++)
+			macro.parameters.push_back(reader.readString());
+
+		size_t macroLabelCount = reader.readU32();
+		for (size_t k = 0; k < macroLabelCount && reader.isValid(); k++)
+			macro.labels.insert(reader.readString());
+
+		macro.content = reader.readTokens();
+		macro.counter = (size_t) reader.readU64();
+		parser.addMacro(macro);
+	}
+
+	// encoding table
+	if (reader.readU32() != 0)
+	{
+		Global.Table.clear();
+
+		ByteArray termination = reader.readBytes();
+		Global.Table.setTerminationEntry(termination.data(),termination.size());
+
+		size_t entryCount = reader.readU32();
+		for (size_t i = 0; i < entryCount && reader.isValid(); i++)
+		{
+			ByteArray hex = reader.readBytes();
+			Global.Table.addEntry(hex.data(),hex.size(),reader.readString());
+		}
+	}
+
+	if (!reader.isValid() || !reader.atEnd())
+	{
+		Logger::printError(Logger::Error,L"Invalid prelude %s",fileName.wstring());
+		return false;
+	}
+
+	return !Logger::hasError();
+}
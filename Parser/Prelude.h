@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Util/FileSystem.h"
+
+#include <vector>
+
+class Parser;
+struct LabelDefinition;
+
+// A prelude stores the global equs, the defined global labels, the macros
+// and the current encoding table of a finished run. Loading it before
+// parsing restores that state without tokenizing the prelude sources again.
+bool savePrelude(const fs::path& fileName, const Parser& parser);
+bool loadPrelude(const fs::path& fileName, Parser& parser, std::vector<LabelDefinition>& labels);
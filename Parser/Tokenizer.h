@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Util/MemoryStats.h"
+
 #include <list>
 #include <string>
 #include <vector>
@@ -52,7 +54,7 @@ enum class TokenType
 	Separator
 };
 
-struct Token
+struct Token: public MemoryTrackedObject<Token,MemoryCategory::Tokens>
 {
 	friend class Tokenizer;
 
@@ -155,7 +157,10 @@ public:
 	void registerReplacement(const std::wstring& identifier, std::vector<Token>& tokens);
 	void registerReplacement(const std::wstring& identifier, const std::wstring& newValue);
 	static size_t addEquValue(const std::vector<Token>& tokens);
+	static const std::vector<Token>& getEquValue(size_t index) { return equValues[index]; }
+	static size_t getEquValueCount() { return equValues.size(); }
 	static void clearEquValues() { equValues.clear(); }
+	static void truncateEquValues(size_t count) { equValues.resize(count); }
 	void resetLookaheadCheckMarks();
 protected:
 	void clearTokens() { tokens.clear(); };
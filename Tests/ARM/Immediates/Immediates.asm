@@ -14,6 +14,10 @@
 	bic	r6,0FFFFFFh	; test bic conversion to and
 
 	cmp	r6,~1h		; test cmp conversion to cmn
+	cmn	r6,-100h	; test cmn conversion to cmp
+
+	add	r6,-4h		; test add conversion to sub
+	sub	r6,r5,-100h	; test sub conversion to add
 
 				; test shifted immediates
 .macro simm,reg,imm,rot
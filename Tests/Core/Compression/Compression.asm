@@ -0,0 +1,11 @@
+﻿.gba
+.create "output.bin",0
+
+.incbin_lz "data.bin"
+.compress lz11,"data.bin"
+.compress rle,"data.bin"
+.compress lz10,"data.bin",4,60
+end:
+
+.notice tohex(end)
+.close
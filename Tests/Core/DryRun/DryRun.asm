@@ -0,0 +1,18 @@
+.gba
+
+.open "input.bin","output.bin",0
+.org 0x10
+.byte 1,2,3,4
+.org 0xFFFE
+.word 0x12345678
+.org 0xFFFC
+.halfword 0xAABB
+.org 0x18000
+.byte 5
+.close
+
+.create "output2.bin",0
+.fill 0x20000,0x11
+.org 0x1FFFF
+.byte 6
+.close
@@ -0,0 +1,25 @@
+.gba
+.create "output.bin",0
+
+; the string conversion shows the parsed tree, so these check that each
+; operator binds like before and that equal precedence is left associative
+.notice °(1 + 2 * 3 - 4 / 5 % 6)
+.notice °(1 - 2 - 3 + 4)
+.notice °(1 << 2 + 3 >> 4 << 5)
+.notice °(1 < 2 << 3 <= 4 > 5 >= 6)
+.notice °(1 == 2 < 3 != 4 == 5)
+.notice °(1 & 2 == 3 & 4)
+.notice °(1 ^ 2 & 3 ^ 4)
+.notice °(1 | 2 ^ 3 | 4)
+.notice °(1 && 2 | 3 && 4)
+.notice °(1 || 2 && 3 || 4)
+.notice °(1 || 2 ? 3 + 4 : 5 ? 6 : 7)
+.notice °(-1 * ~2 + !3 - -4)
+.notice °((1 + 2) * (3 - 4) << (5 & 6))
+.notice °(min(1 + 2, 3 * 4) - max(5, 6) * 7)
+.notice °(1 * 2 + 3 << 4 < 5 == 6 & 7 ^ 8 | 9 && 10 || 11)
+.notice °(11 || 10 && 9 | 8 ^ 7 & 6 == 5 < 4 << 3 + 2 * 1)
+.notice tohex(0x10 | 0x20 & 0x30 ^ 0x40 + 1 << 2 >> 1)
+.notice tostring(1 + 2 * 3 == 7 && 8 / 2 - 1 >= 3 || 0)
+
+.close
@@ -0,0 +1,4 @@
+.gba
+.arm
+
+setup:
@@ -0,0 +1,18 @@
+.thumb
+
+.macro m,arg
+	mov r0,arg
+.endmacro
+
+label:
+value equ 1
+	m value
+;---
+.macro m,arg
+	mov r1,arg
+.endmacro
+
+label:
+value equ 2
+	mov r0,value
+	m value
@@ -0,0 +1,24 @@
+.psx
+.autoregionpacking bestfit
+.create "output.bin", 0
+
+.defineregion 0h,24h,0EEh
+.defineregion 40h,10h,0EEh
+
+; first fit would put A into the first region, leaving no space for B
+.autoregion
+.notice "Allocated A at " + tohex(.)
+.fill 10h,1
+.endautoregion
+
+.autoregion
+.notice "Allocated B at " + tohex(.)
+.fill 20h,2
+.endautoregion
+
+.autoregion 0h,3Fh
+.notice "Allocated C at " + tohex(.)
+.word 3
+.endautoregion
+
+.close
@@ -35,11 +35,16 @@ ByteArray::ByteArray(ByteArray&& other)
 
 ByteArray::~ByteArray()
 {
+	MemoryStats::release(MemoryCategory::Buffers,allocatedSize_);
 	free(data_);
 }
 
-ByteArray& ByteArray::operator=(ByteArray& other)
+ByteArray& ByteArray::operator=(const ByteArray& other)
 {
+	if (this == &other)
+		return *this;
+
+	MemoryStats::release(MemoryCategory::Buffers,allocatedSize_);
 	free(data_);
 	data_ = nullptr;
 	size_ = allocatedSize_ = 0;
@@ -50,6 +55,12 @@ ByteArray& ByteArray::operator=(ByteArray& other)
 
 ByteArray& ByteArray::operator=(ByteArray&& other)
 {
+	if (this == &other)
+		return *this;
+
+	MemoryStats::release(MemoryCategory::Buffers,allocatedSize_);
+	free(data_);
+
 	data_ = other.data_;
 	size_ = other.size_;
 	allocatedSize_ = other.allocatedSize_;
@@ -63,7 +74,9 @@ void ByteArray::grow(size_t neededSize)
 	if (neededSize < allocatedSize_) return;
 
 	// align to next 0.5kb... it's a start
-	allocatedSize_ = ((neededSize+511)/512)*512;
+	size_t newSize = ((neededSize+511)/512)*512;
+	MemoryStats::resize(MemoryCategory::Buffers,allocatedSize_,newSize);
+	allocatedSize_ = newSize;
 	if (data_ == nullptr)
 	{
 		data_ = (byte*) malloc(allocatedSize_);
@@ -122,7 +135,7 @@ void ByteArray::resize(size_t newSize)
 	size_ = newSize;
 }
 
-ByteArray ByteArray::mid(size_t start, ssize_t length)
+ByteArray ByteArray::mid(size_t start, ssize_t length) const
 {
 	ByteArray ret;
 
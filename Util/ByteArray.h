@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Util/FileSystem.h"
+#include "Util/MemoryStats.h"
 
 #include <string>
 
@@ -22,7 +23,7 @@ public:
 	ByteArray(byte* data, size_t size);
 	ByteArray(ByteArray&& other);
 	~ByteArray();
-	ByteArray& operator=(ByteArray& other);
+	ByteArray& operator=(const ByteArray& other);
 	ByteArray& operator=(ByteArray&& other);
 
 	size_t append(const ByteArray& other);
@@ -107,9 +108,9 @@ public:
 	byte* data(size_t pos = 0) const { return &data_[pos]; };
 	void clear() { size_ = 0; };
 	void resize(size_t newSize);
-	ByteArray mid(size_t start, ssize_t length = 0);
-	ByteArray left(size_t length) { return mid(0,length); };
-	ByteArray right(size_t length) { return mid(size_-length,length); };
+	ByteArray mid(size_t start, ssize_t length = 0) const;
+	ByteArray left(size_t length) const { return mid(0,length); };
+	ByteArray right(size_t length) const { return mid(size_-length,length); };
 
 	static ByteArray fromFile(const fs::path& fileName, long start = 0, size_t size = 0);
 	bool toFile(const fs::path& fileName);
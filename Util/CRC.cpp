@@ -84,9 +84,10 @@ unsigned short getCrc16(unsigned char* Source, size_t len)
 	return crc;
 }
 
-unsigned int getCrc32(unsigned char* Source, size_t len)
+unsigned int getCrc32(unsigned char* Source, size_t len, unsigned int previous)
 {
-	unsigned int crc = 0xFFFFFFFF;
+	// continues the checksum of the previous data
+	unsigned int crc = previous ^ 0xFFFFFFFF;
 
 	while (len--)
 	{
@@ -104,3 +105,14 @@ unsigned int getChecksum(unsigned char* Source, size_t len)
 		checksum += *Source++;
 	return checksum;
 }
+
+uint64_t getFnv1a64(const unsigned char* Source, size_t len, uint64_t hash)
+{
+	while (len--)
+	{
+		hash ^= *Source++;
+		hash *= 0x100000001B3ull;
+	}
+
+	return hash;
+}
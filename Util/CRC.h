@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 unsigned short getCrc16(unsigned char* Source, size_t len);
-unsigned int getCrc32(unsigned char* Source, size_t len);
+unsigned int getCrc32(unsigned char* Source, size_t len, unsigned int previous = 0);
 unsigned int getChecksum(unsigned char* Source, size_t len);
+uint64_t getFnv1a64(const unsigned char* Source, size_t len, uint64_t hash = 0xCBF29CE484222325ull);
@@ -0,0 +1,346 @@
+#include "Util/Compression.h"
+
+#include "Util/CRC.h"
+#include "Util/Util.h"
+
+#include <tinyformat.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const size_t hashSize = 1 << 12;
+	const size_t maxChainLength = 1024;
+
+	// finds the longest earlier match at a position using hash chains over
+	// the first three bytes
+	class MatchFinder
+	{
+	public:
+		MatchFinder(const ByteArray& data, size_t windowSize, size_t minDistance)
+			: data(data), windowSize(windowSize), minDistance(minDistance),
+			head(hashSize,-1), previous(data.size(),-1)
+		{
+		}
+
+		void insert(size_t pos)
+		{
+			if (pos+2 >= data.size())
+				return;
+
+			size_t hash = getHash(pos);
+			previous[pos] = head[hash];
+			head[hash] = (ssize_t) pos;
+		}
+
+		size_t find(size_t pos, size_t maxLength, size_t& distance)
+		{
+			if (pos+2 >= data.size())
+				return 0;
+
+			size_t bestLength = 0;
+			size_t chainLength = 0;
+			for (ssize_t candidate = head[getHash(pos)]; candidate >= 0 && chainLength < maxChainLength;
+				candidate = previous[candidate], chainLength++)
+			{
+				size_t candidateDistance = pos-(size_t)candidate;
+				if (candidateDistance > windowSize)
+					break;
+				if (candidateDistance < minDistance)
+					continue;
+
+				size_t length = 0;
+				while (length < maxLength && data[candidate+length] == data[pos+length])
+					length++;
+
+				if (length > bestLength)
+				{
+					bestLength = length;
+					distance = candidateDistance;
+					if (length == maxLength)
+						break;
+				}
+			}
+
+			return bestLength;
+		}
+	private:
+		size_t getHash(size_t pos) const
+		{
+			return ((data[pos] << 8) ^ (data[pos+1] << 4) ^ data[pos+2]) & (hashSize-1);
+		}
+
+		const ByteArray& data;
+		size_t windowSize;
+		size_t minDistance;
+		std::vector<ssize_t> head;
+		std::vector<ssize_t> previous;
+	};
+
+	void appendHeader(ByteArray& result, uint8_t type, size_t size)
+	{
+		result.appendByte(type);
+		result.appendByte(size & 0xFF);
+		result.appendByte((size >> 8) & 0xFF);
+		result.appendByte((size >> 16) & 0xFF);
+	}
+
+	// shared by lz10 and lz11, which only differ in the encoding of a match
+	template <typename Func>
+	void compressLz(const ByteArray& data, ByteArray& result, size_t maxLength, size_t minDistance, Func writeMatch)
+	{
+		MatchFinder finder(data,0x1000,minDistance);
+
+		size_t pos = 0;
+		while (pos < data.size())
+		{
+			size_t flagPos = result.appendByte(0);
+			byte flags = 0;
+
+			for (int bit = 0; bit < 8 && pos < data.size(); bit++)
+			{
+				size_t distance = 0;
+				size_t length = finder.find(pos,std::min(maxLength,data.size()-pos),distance);
+
+				if (length >= 3)
+				{
+					flags |= 0x80 >> bit;
+					writeMatch(length,distance);
+				} else {
+					length = 1;
+					result.appendByte(data[pos]);
+				}
+
+				for (size_t i = 0; i < length; i++)
+					finder.insert(pos++);
+			}
+
+			result.replaceByte(flagPos,flags);
+		}
+	}
+
+	void compressLz10(const ByteArray& data, ByteArray& result)
+	{
+		appendHeader(result,0x10,data.size());
+
+		// a distance of 1 would read bytes that weren't written yet when
+		// decompressing to vram with 16 bit accesses, so it's never used
+		compressLz(data,result,18,2,[&](size_t length, size_t distance)
+		{
+			result.appendByte((byte) (((length-3) << 4) | ((distance-1) >> 8)));
+			result.appendByte((byte) ((distance-1) & 0xFF));
+		});
+	}
+
+	void compressLz11(const ByteArray& data, ByteArray& result)
+	{
+		appendHeader(result,0x11,data.size());
+
+		compressLz(data,result,0x10110,1,[&](size_t length, size_t distance)
+		{
+			size_t disp = distance-1;
+			if (length <= 0x10)
+			{
+				result.appendByte((byte) (((length-1) << 4) | (disp >> 8)));
+			} else if (length <= 0x110)
+			{
+				size_t value = length-0x11;
+				result.appendByte((byte) (value >> 4));
+				result.appendByte((byte) (((value & 0xF) << 4) | (disp >> 8)));
+			} else {
+				size_t value = length-0x111;
+				result.appendByte((byte) (0x10 | (value >> 12)));
+				result.appendByte((byte) ((value >> 4) & 0xFF));
+				result.appendByte((byte) (((value & 0xF) << 4) | (disp >> 8)));
+			}
+
+			result.appendByte((byte) (disp & 0xFF));
+		});
+	}
+
+	void compressRle(const ByteArray& data, ByteArray& result)
+	{
+		appendHeader(result,0x30,data.size());
+
+		size_t literalStart = 0;
+		size_t pos = 0;
+
+		auto flushLiterals = [&]()
+		{
+			while (literalStart < pos)
+			{
+				size_t count = std::min<size_t>(pos-literalStart,0x80);
+				result.appendByte((byte) (count-1));
+				result.append(data.data(literalStart),count);
+				literalStart += count;
+			}
+		};
+
+		while (pos < data.size())
+		{
+			size_t run = 1;
+			while (run < 0x82 && pos+run < data.size() && data[pos+run] == data[pos])
+				run++;
+
+			if (run < 3)
+			{
+				pos++;
+				continue;
+			}
+
+			flushLiterals();
+			result.appendByte((byte) (0x80 | (run-3)));
+			result.appendByte(data[pos]);
+
+			pos += run;
+			literalStart = pos;
+		}
+
+		flushLiterals();
+	}
+}
+
+bool parseCompressionType(const std::wstring& name, CompressionType& result)
+{
+	if (name == L"lz10" || name == L"lz77")
+		result = CompressionType::Lz10;
+	else if (name == L"lz11")
+		result = CompressionType::Lz11;
+	else if (name == L"rle")
+		result = CompressionType::Rle;
+	else
+		return false;
+
+	return true;
+}
+
+const wchar_t* getCompressionTypeName(CompressionType type)
+{
+	switch (type)
+	{
+	case CompressionType::Lz10:
+		return L"lz10";
+	case CompressionType::Lz11:
+		return L"lz11";
+	case CompressionType::Rle:
+		return L"rle";
+	}
+
+	return L"";
+}
+
+bool compressData(const ByteArray& data, CompressionType type, ByteArray& result)
+{
+	result.clear();
+
+	// the size has to fit into the 24 bit header field
+	if (data.size() > 0xFFFFFF)
+		return false;
+
+	switch (type)
+	{
+	case CompressionType::Lz10:
+		compressLz10(data,result);
+		break;
+	case CompressionType::Lz11:
+		compressLz11(data,result);
+		break;
+	case CompressionType::Rle:
+		compressRle(data,result);
+		break;
+	}
+
+	result.alignSize(4);
+	return true;
+}
+
+void CompressionCache::setDirectory(const fs::path& path)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	directory = path;
+}
+
+void CompressionCache::clear()
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	entries.clear();
+}
+
+fs::path CompressionCache::getCacheFileName(const Key& key) const
+{
+	std::wstring name = tfm::format(L"%s_%08X_%016llX_%08X.bin",getCompressionTypeName(std::get<0>(key)),
+		std::get<1>(key),std::get<2>(key),std::get<3>(key));
+	return directory / name;
+}
+
+bool CompressionCache::readCacheFile(const fs::path& fileName, ByteArray& result)
+{
+	ByteArray file = ByteArray::fromFile(fileName);
+	if (file.size() < 8)
+		return false;
+
+	// entries with a different size or checksum were not fully written
+	size_t size = (unsigned int) file.getDoubleWord(0);
+	unsigned int crc = (unsigned int) file.getDoubleWord(4);
+	if (size == 0 || size != file.size()-8 || crc != getCrc32(file.data(8),size))
+		return false;
+
+	result = file.mid(8,size);
+	return true;
+}
+
+void CompressionCache::writeCacheFile(const fs::path& fileName, const ByteArray& data)
+{
+	std::error_code error;
+	fs::create_directories(fileName.parent_path(),error);
+
+	ByteArray file;
+	file.reserveBytes(8);
+	file.replaceDoubleWord(0,(unsigned int) data.size());
+	file.replaceDoubleWord(4,getCrc32(data.data(),data.size()));
+	file.append(data);
+
+	// readers never see partially written entries
+	fs::path tempName = getTemporaryFileName(fileName);
+	if (file.toFile(tempName))
+		fs::rename(tempName,fileName,error);
+
+	// only left over if writing or renaming failed
+	fs::remove(tempName,error);
+}
+
+bool CompressionCache::compress(const ByteArray& data, CompressionType type, ByteArray& result)
+{
+	Key key(type,data.size(),getFnv1a64(data.data(),data.size()),getCrc32(data.data(),data.size()));
+
+	fs::path cacheFileName;
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		auto it = entries.find(key);
+		if (it != entries.end())
+		{
+			result = ByteArray(it->second);
+			return true;
+		}
+
+		if (!directory.empty())
+			cacheFileName = getCacheFileName(key);
+	}
+
+	bool cached = !cacheFileName.empty() && fs::exists(cacheFileName)
+		&& readCacheFile(cacheFileName,result);
+
+	if (!cached)
+	{
+		if (!compressData(data,type,result))
+			return false;
+
+		if (!cacheFileName.empty())
+			writeCacheFile(cacheFileName,result);
+	}
+
+	std::lock_guard<std::mutex> guard(mutex);
+	entries[key] = ByteArray(result);
+	return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Util/ByteArray.h"
+#include "Util/FileSystem.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// formats of the GBA/NDS BIOS decompression functions
+enum class CompressionType { Lz10, Lz11, Rle };
+
+bool parseCompressionType(const std::wstring& name, CompressionType& result);
+const wchar_t* getCompressionTypeName(CompressionType type);
+
+// compresses data including the BIOS header and pads the result to a
+// multiple of 4 bytes. returns false if the data is too large for the format
+bool compressData(const ByteArray& data, CompressionType type, ByteArray& result);
+
+// Compressed data keyed by a hash of the input. Entries are kept in memory
+// for the current run and additionally stored in the cache directory, if
+// one is set, so unchanged inputs are never compressed twice. Stored entries
+// start with the size and checksum of the data, entries that don't match
+// them are compressed again. Can be used from multiple threads.
+class CompressionCache
+{
+public:
+	void setDirectory(const fs::path& path);
+	bool compress(const ByteArray& data, CompressionType type, ByteArray& result);
+	void clear();
+private:
+	typedef std::tuple<CompressionType,size_t,uint64_t,uint32_t> Key;
+
+	fs::path getCacheFileName(const Key& key) const;
+	static bool readCacheFile(const fs::path& fileName, ByteArray& result);
+	static void writeCacheFile(const fs::path& fileName, const ByteArray& data);
+
+	std::mutex mutex;
+	fs::path directory;
+	std::map<Key,ByteArray> entries;
+};
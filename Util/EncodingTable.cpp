@@ -3,6 +3,8 @@
 #include "Core/Common.h"
 #include "Util/Util.h"
 
+#include <atomic>
+
 #define MAXHEXLENGTH 32
 
 Trie::Trie()
@@ -79,6 +81,7 @@ bool Trie::findLongestPrefix(const wchar_t* text, size_t& result)
 }
 
 EncodingTable::EncodingTable()
+	: revision(0)
 {
 
 }
@@ -88,10 +91,19 @@ EncodingTable::~EncodingTable()
 
 }
 
+void EncodingTable::modified()
+{
+	static std::atomic<uint64_t> nextRevision(1);
+	revision = nextRevision++;
+}
+
 void EncodingTable::clear()
 {
+	modified();
 	hexData.clear();
 	entries.clear();
+	values.clear();
+	lookup = Trie();
 }
 
 int parseHexString(std::wstring& hex, unsigned char* dest)
@@ -129,6 +141,7 @@ bool EncodingTable::load(const fs::path& fileName, TextFile::Encoding encoding)
 	if (!input.open(fileName,TextFile::Read,encoding))
 		return false;
 
+	modified();
 	hexData.clear();
 	entries.clear();
 	setTerminationEntry((unsigned char*)"\0",1);
@@ -185,6 +198,8 @@ void EncodingTable::addEntry(unsigned char* hex, size_t hexLength, const std::ws
 	if (value.size() == 0)
 		return;
 	
+	modified();
+
 	// insert into trie
 	size_t index = entries.size();
 	lookup.insert(value.c_str(),index);
@@ -196,6 +211,7 @@ void EncodingTable::addEntry(unsigned char* hex, size_t hexLength, const std::ws
 	entry.valueLen = value.size();
 
 	entries.push_back(entry);
+	values.push_back(value);
 }
 
 void EncodingTable::addEntry(unsigned char* hex, size_t hexLength, wchar_t value)
@@ -203,6 +219,8 @@ void EncodingTable::addEntry(unsigned char* hex, size_t hexLength, wchar_t value
 	if (value == '\0')
 		return;
 	
+	modified();
+
 	// insert into trie
 	size_t index = entries.size();
 	lookup.insert(value,index);
@@ -214,11 +232,13 @@ void EncodingTable::addEntry(unsigned char* hex, size_t hexLength, wchar_t value
 	entry.valueLen = 1;
 	
 	entries.push_back(entry);
+	values.push_back(std::wstring(1,value));
 
 }
 
 void EncodingTable::setTerminationEntry(unsigned char* hex, size_t hexLength)
 {
+	modified();
 	terminationEntry.hexPos = hexData.append(hex,hexLength);
 	terminationEntry.hexLen = hexLength;
 	terminationEntry.valueLen = 0;
@@ -3,6 +3,7 @@
 #include "Util/ByteArray.h"
 #include "Util/FileClasses.h"
 
+#include <cstdint>
 #include <map>
 #include <vector>
 
@@ -51,7 +52,17 @@ public:
 	void setTerminationEntry(unsigned char* hex, size_t hexLength);
 	ByteArray encodeString(const std::wstring& str, bool writeTermination = true);
 	ByteArray encodeTermination();
+
+	size_t getEntryCount() const { return entries.size(); }
+	ByteArray getEntryHex(size_t index) const { return hexData.mid(entries[index].hexPos,entries[index].hexLen); }
+	const std::wstring& getEntryValue(size_t index) const { return values[index]; }
+	ByteArray getTerminationHex() const { return hexData.mid(terminationEntry.hexPos,terminationEntry.hexLen); }
+	// changes with every modification and is kept by copies, so equal
+	// revisions mean equal content
+	uint64_t getRevision() const { return revision; }
 private:
+	void modified();
+
 	struct TableEntry
 	{
 		size_t hexPos;
@@ -61,6 +72,8 @@ private:
 
 	ByteArray hexData;
 	std::vector<TableEntry> entries;
+	std::vector<std::wstring> values;
 	Trie lookup;
 	TableEntry terminationEntry;
+	uint64_t revision;
 };
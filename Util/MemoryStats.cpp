@@ -0,0 +1,92 @@
+#include "Util/MemoryStats.h"
+
+#include <algorithm>
+
+std::atomic<bool> MemoryStats::enabled(false);
+MemoryStats::Counter MemoryStats::counters[(size_t)MemoryCategory::Count];
+MemoryStats::Counter MemoryStats::total;
+
+static void updatePeak(std::atomic<int64_t>& peak, int64_t value)
+{
+	int64_t oldPeak = peak.load();
+	while (value > oldPeak && !peak.compare_exchange_weak(oldPeak,value))
+		;
+}
+
+void MemoryStats::setEnabled(bool state)
+{
+	if (state)
+	{
+		for (Counter& counter: counters)
+		{
+			counter.current = 0;
+			counter.peak = 0;
+		}
+
+		total.current = 0;
+		total.peak = 0;
+	}
+
+	enabled = state;
+}
+
+void* MemoryStats::allocateHeap(MemoryCategory category, size_t size)
+{
+	allocate(category,size);
+	return ::operator new(size);
+}
+
+void MemoryStats::releaseHeap(MemoryCategory category, void* ptr, size_t size)
+{
+	release(category,size);
+	::operator delete(ptr,size);
+}
+
+void MemoryStats::update(MemoryCategory category, int64_t delta)
+{
+	Counter& counter = counters[(size_t)category];
+	updatePeak(counter.peak,counter.current += delta);
+	updatePeak(total.peak,total.current += delta);
+}
+
+MemoryCategoryStats MemoryStats::get(MemoryCategory category)
+{
+	const Counter& counter = counters[(size_t)category];
+
+	// objects created before counting started may still be released
+	MemoryCategoryStats result;
+	result.current = std::max<int64_t>(counter.current.load(),0);
+	result.peak = counter.peak.load();
+	return result;
+}
+
+MemoryCategoryStats MemoryStats::getTotal()
+{
+	MemoryCategoryStats result;
+	result.current = std::max<int64_t>(total.current.load(),0);
+	result.peak = total.peak.load();
+	return result;
+}
+
+const wchar_t* MemoryStats::getCategoryName(MemoryCategory category)
+{
+	switch (category)
+	{
+	case MemoryCategory::Tokens:
+		return L"Tokens";
+	case MemoryCategory::Commands:
+		return L"Commands";
+	case MemoryCategory::Expressions:
+		return L"Expressions";
+	case MemoryCategory::Symbols:
+		return L"Symbols";
+	case MemoryCategory::EncodedData:
+		return L"Encoded data";
+	case MemoryCategory::Buffers:
+		return L"Data buffers";
+	case MemoryCategory::Count:
+		break;
+	}
+
+	return L"";
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+enum class MemoryCategory { Tokens, Commands, Expressions, Symbols, EncodedData, Buffers, Count };
+
+struct MemoryCategoryStats
+{
+	int64_t current;
+	int64_t peak;
+};
+
+// Keeps track of the memory used by the main data structures. Counting only
+// happens while enabled, otherwise every hook is a single branch.
+class MemoryStats
+{
+public:
+	static void setEnabled(bool state);
+	static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	static void allocate(MemoryCategory category, size_t bytes)
+	{
+		if (isEnabled())
+			update(category,(int64_t)bytes);
+	}
+
+	static void release(MemoryCategory category, size_t bytes)
+	{
+		if (isEnabled())
+			update(category,-(int64_t)bytes);
+	}
+
+	static void resize(MemoryCategory category, size_t oldBytes, size_t newBytes)
+	{
+		if (isEnabled() && oldBytes != newBytes)
+			update(category,(int64_t)newBytes-(int64_t)oldBytes);
+	}
+
+	// out of line, so the compiler sees the allocation and the release of
+	// MemoryTrackedHeap as one matching pair
+	static void* allocateHeap(MemoryCategory category, size_t size);
+	static void releaseHeap(MemoryCategory category, void* ptr, size_t size);
+
+	static MemoryCategoryStats get(MemoryCategory category);
+	static MemoryCategoryStats getTotal();
+	static const wchar_t* getCategoryName(MemoryCategory category);
+private:
+	static void update(MemoryCategory category, int64_t delta);
+
+	struct Counter
+	{
+		std::atomic<int64_t> current;
+		std::atomic<int64_t> peak;
+	};
+
+	static std::atomic<bool> enabled;
+	static Counter counters[(size_t)MemoryCategory::Count];
+	static Counter total;
+};
+
+// Base for classes that are allocated individually on the heap. The sized
+// delete also receives the size of derived classes with virtual destructors.
+template <MemoryCategory Category>
+class MemoryTrackedHeap
+{
+public:
+	static void* operator new(size_t size)
+	{
+		return MemoryStats::allocateHeap(Category,size);
+	}
+
+	static void operator delete(void* ptr, size_t size)
+	{
+		MemoryStats::releaseHeap(Category,ptr,size);
+	}
+};
+
+// Base for value types that live inside containers, counts every instance
+template <typename T, MemoryCategory Category>
+class MemoryTrackedObject
+{
+public:
+	MemoryTrackedObject() { MemoryStats::allocate(Category,sizeof(T)); }
+	MemoryTrackedObject(const MemoryTrackedObject&) { MemoryStats::allocate(Category,sizeof(T)); }
+	~MemoryTrackedObject() { MemoryStats::release(Category,sizeof(T)); }
+	MemoryTrackedObject& operator=(const MemoryTrackedObject&) { return *this; }
+};
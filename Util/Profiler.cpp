@@ -0,0 +1,187 @@
+#include "Util/Profiler.h"
+
+#include <algorithm>
+
+bool Profiler::enabled = false;
+std::thread::id Profiler::owner;
+std::vector<Profiler::Frame> Profiler::stack;
+std::unordered_map<uint64_t,ProfileEntry> Profiler::lines;
+std::map<std::wstring,int> Profiler::macroIds;
+std::deque<std::pair<std::wstring,ProfileEntry>> Profiler::macros;
+
+double ProfileEntry::getTotalTime() const
+{
+	double result = 0;
+	for (double value: time)
+		result += value;
+	return result;
+}
+
+void ProfileEntry::add(const ProfileEntry& other)
+{
+	for (size_t i = 0; i < (size_t)ProfilePhase::Count; i++)
+		time[i] += other.time[i];
+
+	evaluations += other.evaluations;
+	bytes += other.bytes;
+	revalidations += other.revalidations;
+}
+
+void Profiler::setEnabled(bool state)
+{
+	stack.clear();
+	lines.clear();
+	macroIds.clear();
+	macros.clear();
+
+	owner = std::this_thread::get_id();
+	enabled = state;
+}
+
+bool Profiler::enterLine(ProfilePhase phase, int fileNum, int line)
+{
+	if (fileNum < 0 || !isOwner())
+		return false;
+
+	Clock::time_point start = Clock::now();
+	uint64_t key = ((uint64_t)(uint32_t)fileNum << 32) | (uint32_t)line;
+	stack.push_back({ &lines[key], phase, start, 0, false, false, false });
+	return true;
+}
+
+bool Profiler::enterMacro(ProfilePhase phase, int macroId)
+{
+	if (!isOwner())
+		return false;
+
+	stack.push_back({ &macros[(size_t)macroId].second, phase, Clock::now(), 0, true, false, false });
+	return true;
+}
+
+void Profiler::leave()
+{
+	Frame frame = stack.back();
+	stack.pop_back();
+
+	Clock::time_point end = Clock::now();
+	double elapsed = std::chrono::duration<double,std::milli>(end-frame.start).count();
+	if (frame.macro)
+	{
+		frame.entry->time[(size_t)frame.phase] += elapsed;
+		return;
+	}
+
+	frame.entry->time[(size_t)frame.phase] += elapsed-frame.childTime;
+
+	// a pass is only blamed on the innermost line that requested it
+	if (frame.changed && !frame.childChanged)
+		frame.entry->revalidations++;
+
+	// the bookkeeping of nested lines isn't part of the time of their parent
+	for (size_t i = stack.size(); i > 0; i--)
+	{
+		Frame& parent = stack[i-1];
+		if (!parent.macro)
+		{
+			parent.childTime += std::chrono::duration<double,std::milli>(Clock::now()-frame.start).count();
+			parent.childChanged |= frame.changed || frame.childChanged;
+			break;
+		}
+	}
+}
+
+void Profiler::markChanged()
+{
+	stack.back().changed = true;
+}
+
+int Profiler::getMacroId(const std::wstring& name)
+{
+	if (!enabled || !isOwner())
+		return -1;
+
+	auto it = macroIds.find(name);
+	if (it != macroIds.end())
+		return it->second;
+
+	int id = (int) macros.size();
+	macros.emplace_back(name,ProfileEntry());
+	macroIds[name] = id;
+	return id;
+}
+
+void Profiler::addEvaluation()
+{
+	if (!isOwner())
+		return;
+
+	// counts for the innermost line and every macro around it
+	bool lineFound = false;
+	for (size_t i = stack.size(); i > 0; i--)
+	{
+		Frame& frame = stack[i-1];
+		if (frame.macro || !lineFound)
+			frame.entry->evaluations++;
+		lineFound |= !frame.macro;
+	}
+}
+
+void Profiler::addBytes(size_t bytes)
+{
+	if (!isOwner())
+		return;
+
+	bool lineFound = false;
+	for (size_t i = stack.size(); i > 0; i--)
+	{
+		Frame& frame = stack[i-1];
+		if (frame.macro || !lineFound)
+			frame.entry->bytes += bytes;
+		lineFound |= !frame.macro;
+	}
+}
+
+static void sortLocations(std::vector<ProfileLocation>& locations, size_t count)
+{
+	std::sort(locations.begin(),locations.end(),[](const ProfileLocation& a, const ProfileLocation& b)
+	{
+		return a.entry.getTotalTime() > b.entry.getTotalTime();
+	});
+
+	if (locations.size() > count)
+		locations.resize(count);
+}
+
+std::vector<ProfileLocation> Profiler::getLines(size_t count)
+{
+	std::vector<ProfileLocation> result;
+	for (const auto& it: lines)
+		result.push_back({ (int)(it.first >> 32), (int)(uint32_t)it.first, L"", it.second });
+
+	sortLocations(result,count);
+	return result;
+}
+
+std::vector<ProfileLocation> Profiler::getFiles(size_t count)
+{
+	std::map<int,ProfileEntry> files;
+	for (const auto& it: lines)
+		files[(int)(it.first >> 32)].add(it.second);
+
+	std::vector<ProfileLocation> result;
+	for (const auto& it: files)
+		result.push_back({ it.first, -1, L"", it.second });
+
+	sortLocations(result,count);
+	return result;
+}
+
+std::vector<ProfileLocation> Profiler::getMacros(size_t count)
+{
+	std::vector<ProfileLocation> result;
+	for (const auto& it: macros)
+		result.push_back({ -1, -1, it.first, it.second });
+
+	sortLocations(result,count);
+	return result;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class ProfilePhase { Parse, Validate, Encode, Count };
+
+struct ProfileEntry
+{
+	double time[(size_t)ProfilePhase::Count] = {};
+	int64_t evaluations = 0;
+	int64_t bytes = 0;
+	int64_t revalidations = 0;
+
+	double getTotalTime() const;
+	void add(const ProfileEntry& other);
+};
+
+// a source line, a whole file if line is -1, or a macro if name is set
+struct ProfileLocation
+{
+	int fileNum;
+	int line;
+	std::wstring name;
+	ProfileEntry entry;
+};
+
+// Attributes the time spent in each phase, the evaluated expressions, the
+// written bytes and the requested validation passes to source lines and
+// macros. Time of nested lines, like the commands of an included file, only
+// counts for the innermost line, while macros include everything they
+// expand to. Only the thread that enabled it is recorded, otherwise every
+// hook is a single branch.
+class Profiler
+{
+public:
+	static void setEnabled(bool state);
+	static bool isEnabled() { return enabled; }
+
+	class LineScope
+	{
+	public:
+		LineScope(ProfilePhase phase, int fileNum, int line)
+			: active(enabled && enterLine(phase,fileNum,line)) { }
+		~LineScope() { if (active) leave(); }
+		// the command requested another validation pass
+		void markChanged() { if (active) Profiler::markChanged(); }
+	private:
+		bool active;
+	};
+
+	class MacroScope
+	{
+	public:
+		MacroScope(ProfilePhase phase, int macroId)
+			: active(enabled && macroId >= 0 && enterMacro(phase,macroId)) { }
+		~MacroScope() { if (active) leave(); }
+	private:
+		bool active;
+	};
+
+	static int getMacroId(const std::wstring& name);
+	static void countEvaluation() { if (enabled) addEvaluation(); }
+	static void countBytes(size_t bytes) { if (enabled) addBytes(bytes); }
+
+	// the top entries, sorted by total time
+	static std::vector<ProfileLocation> getLines(size_t count);
+	static std::vector<ProfileLocation> getFiles(size_t count);
+	static std::vector<ProfileLocation> getMacros(size_t count);
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Frame
+	{
+		ProfileEntry* entry;
+		ProfilePhase phase;
+		Clock::time_point start;
+		double childTime;
+		bool macro;
+		bool changed;
+		bool childChanged;
+	};
+
+	static bool enterLine(ProfilePhase phase, int fileNum, int line);
+	static bool enterMacro(ProfilePhase phase, int macroId);
+	static void leave();
+	static void markChanged();
+	static void addEvaluation();
+	static void addBytes(size_t bytes);
+	static bool isOwner() { return std::this_thread::get_id() == owner; }
+
+	static bool enabled;
+	static std::thread::id owner;
+	static std::vector<Frame> stack;
+	static std::unordered_map<uint64_t,ProfileEntry> lines;
+	static std::map<std::wstring,int> macroIds;
+	static std::deque<std::pair<std::wstring,ProfileEntry>> macros;
+};
@@ -0,0 +1,156 @@
+#include "Util/ThreadPool.h"
+
+namespace
+{
+	thread_local const ThreadPool* currentPool = nullptr;
+	thread_local size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+	: queuedTasks(0), nextQueue(0), stopping(false)
+{
+	if (threadCount == 0)
+		threadCount = getDefaultThreadCount();
+
+	for (size_t i = 1; i < threadCount; i++)
+		workers.push_back(std::make_unique<Worker>());
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i]->thread = std::thread(&ThreadPool::workerLoop,this,i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	sleepCondition.notify_all();
+
+	for (auto& worker: workers)
+		worker->thread.join();
+}
+
+size_t ThreadPool::getDefaultThreadCount()
+{
+	size_t count = std::thread::hardware_concurrency();
+	return count != 0 ? count : 1;
+}
+
+size_t ThreadPool::getCurrentWorker() const
+{
+	return currentPool == this ? currentWorker : workers.size();
+}
+
+void ThreadPool::submit(TaskGroup& group, std::function<void()> task)
+{
+	if (workers.empty())
+	{
+		task();
+		return;
+	}
+
+	group.pending++;
+
+	// workers keep their own work local, everything else is spread evenly
+	size_t index = getCurrentWorker();
+	if (index == workers.size())
+		index = nextQueue++ % workers.size();
+
+	{
+		std::lock_guard<std::mutex> lock(workers[index]->mutex);
+		workers[index]->queue.push_back({ std::move(task), &group });
+	}
+	queuedTasks++;
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	sleepCondition.notify_one();
+}
+
+bool ThreadPool::findTask(size_t index, Task& task)
+{
+	if (queuedTasks.load() == 0)
+		return false;
+
+	// newest task of the own queue first, it's most likely still in the cache
+	if (index < workers.size())
+	{
+		Worker& own = *workers[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.queue.empty())
+		{
+			task = std::move(own.queue.back());
+			own.queue.pop_back();
+			queuedTasks--;
+			return true;
+		}
+	}
+
+	// otherwise steal the oldest task of another queue
+	for (size_t i = 1; i <= workers.size(); i++)
+	{
+		Worker& victim = *workers[(index+i) % workers.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.queue.empty())
+		{
+			task = std::move(victim.queue.front());
+			victim.queue.pop_front();
+			queuedTasks--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::runTask(Task& task)
+{
+	task.function();
+
+	if (--task.group->pending == 0)
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		sleepCondition.notify_all();
+	}
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+	currentPool = this;
+	currentWorker = index;
+
+	while (true)
+	{
+		Task task;
+		if (findTask(index,task))
+		{
+			runTask(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.wait(lock, [this]() { return stopping || queuedTasks.load() != 0; });
+		if (stopping && queuedTasks.load() == 0)
+			return;
+	}
+}
+
+void ThreadPool::wait(TaskGroup& group)
+{
+	size_t index = getCurrentWorker();
+
+	while (!group.isDone())
+	{
+		Task task;
+		if (findTask(index,task))
+		{
+			runTask(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.wait(lock, [this,&group]() { return group.isDone() || queuedTasks.load() != 0; });
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool;
+
+// Counts the outstanding tasks of one batch of work so the submitter can
+// wait for exactly that batch
+class TaskGroup
+{
+public:
+	TaskGroup() : pending(0) { };
+	bool isDone() const { return pending.load() == 0; }
+private:
+	friend class ThreadPool;
+	std::atomic<size_t> pending;
+};
+
+// Small work-stealing scheduler. Every worker owns a queue, takes new work from
+// its back and steals from the front of the other queues when it runs dry.
+// Threads waiting for a group help executing tasks instead of blocking, so tasks
+// may submit and wait for further tasks themselves.
+class ThreadPool
+{
+public:
+	// threadCount is the total amount of threads including the calling one,
+	// 0 uses the number of hardware threads. With a single thread all tasks
+	// are executed directly on submission.
+	explicit ThreadPool(size_t threadCount = 0);
+	~ThreadPool();
+
+	size_t getThreadCount() const { return workers.size()+1; }
+	bool isMultiThreaded() const { return !workers.empty(); }
+
+	void submit(TaskGroup& group, std::function<void()> task);
+	void wait(TaskGroup& group);
+
+	// runs function(index) for every index in [0,count) and waits for all of them
+	template <typename Func>
+	void parallelFor(size_t count, Func function)
+	{
+		TaskGroup group;
+		for (size_t i = 0; i < count; i++)
+			submit(group, [&function,i]() { function(i); });
+		wait(group);
+	}
+
+	static size_t getDefaultThreadCount();
+private:
+	struct Task
+	{
+		std::function<void()> function;
+		TaskGroup* group;
+	};
+
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> queue;
+		std::thread thread;
+	};
+
+	void workerLoop(size_t index);
+	bool findTask(size_t index, Task& task);
+	void runTask(Task& task);
+	size_t getCurrentWorker() const;
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<size_t> queuedTasks;
+	std::atomic<size_t> nextQueue;
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	bool stopping;
+};
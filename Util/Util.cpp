@@ -1,13 +1,23 @@
 #include "Util/Util.h"
 
+#include <tinyformat.h>
+
+#include <atomic>
+#include <cstring>
+#include <random>
 #include <sstream>
 
 std::wstring convertUtf8ToWString(const char* source)
+{
+	return convertUtf8ToWString(source,strlen(source));
+}
+
+std::wstring convertUtf8ToWString(const char* source, size_t length)
 {
 	std::wstring result;
 
-	int index = 0;
-	while (source[index] != 0)
+	size_t index = 0;
+	while (index < length)
 	{
 		int extraBytes = 0;
 		int value = source[index++];
@@ -26,6 +36,9 @@ std::wstring convertUtf8ToWString(const char* source)
 			return std::wstring();
 		}
 
+		if (length-index < (size_t) extraBytes)
+			return std::wstring();
+
 		for (int i = 0; i < extraBytes; i++)
 		{
 			int b = source[index++];
@@ -88,6 +101,56 @@ std::string convertWStringToUtf8(const std::wstring& source)
 	return result;
 }
 
+// loads and stores go through memcpy so the loops don't depend on alignment
+// and can be vectorized by the compiler
+template <typename T, T (*swap)(T)>
+static void swapEndiannessUnits(uint8_t* data, size_t count)
+{
+	for (size_t i = 0; i < count; i++, data += sizeof(T))
+	{
+		T value;
+		memcpy(&value,data,sizeof(T));
+		value = swap(value);
+		memcpy(data,&value,sizeof(T));
+	}
+}
+
+void swapEndianness(uint8_t* data, size_t size, size_t unitSize)
+{
+	switch (unitSize)
+	{
+	case 2:
+		swapEndiannessUnits<uint16_t,swapEndianness16>(data,size/2);
+		break;
+	case 4:
+		swapEndiannessUnits<uint32_t,swapEndianness32>(data,size/4);
+		break;
+	case 8:
+		swapEndiannessUnits<uint64_t,swapEndianness64>(data,size/8);
+		break;
+	}
+}
+
+std::wstring escapeJsonString(const std::wstring& text)
+{
+	std::wstring result;
+	for (wchar_t c: text)
+	{
+		if (c == L'"' || c == L'\\')
+		{
+			result += L'\\';
+			result += c;
+		} else if (c < 0x20)
+		{
+			result += tfm::format(L"\\u%04X",(int) c);
+		} else {
+			result += c;
+		}
+	}
+
+	return result;
+}
+
 std::wstring intToHexString(unsigned int value, int digits, bool prefix)
 {
 	std::wstring result;
@@ -268,3 +331,19 @@ bool startsWith(const std::wstring& str, const wchar_t* value, size_t stringPos)
 
 	return *value == 0;
 }
+
+fs::path getTemporaryFileName(const fs::path& fileName)
+{
+	static const unsigned int instance = std::random_device()();
+	static std::atomic<unsigned int> counter(0);
+
+	std::error_code error;
+	fs::path result;
+	do
+	{
+		result = fileName;
+		result += tfm::format(L".%08X_%d.tmp",instance,counter++);
+	} while (fs::exists(result,error));
+
+	return result;
+}
@@ -2,12 +2,36 @@
 
 #include "Util/FileSystem.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+inline uint64_t swapEndianness64(uint64_t value)
+{
+	return ((value & 0xFF) << 56) | ((value & 0xFF00) << 40) | ((value & 0xFF0000) << 24) | ((value & 0xFF000000) << 8) |
+	((value & 0xFF00000000) >> 8) | ((value & 0xFF0000000000) >> 24) |
+	((value & 0xFF000000000000) >> 40) | ((value & 0xFF00000000000000) >> 56);
+}
+
+inline uint32_t swapEndianness32(uint32_t value)
+{
+	return ((value & 0xFF) << 24) | ((value & 0xFF00) << 8) | ((value & 0xFF0000) >> 8) | ((value & 0xFF000000) >> 24);
+}
+
+inline uint16_t swapEndianness16(uint16_t value)
+{
+	return ((value & 0xFF) << 8) | ((value & 0xFF00) >> 8);
+}
+
+// reverses the byte order of each unitSize sized element in data
+void swapEndianness(uint8_t* data, size_t size, size_t unitSize);
+
 std::wstring convertUtf8ToWString(const char* source);
+// also converts embedded null characters
+std::wstring convertUtf8ToWString(const char* source, size_t length);
 std::string convertWCharToUtf8(wchar_t character);
 ;std::string convertWStringToUtf8(const std::wstring& source);
+std::wstring escapeJsonString(const std::wstring& text);
 
 std::wstring intToHexString(unsigned int value, int digits, bool prefix = false);
 std::wstring intToString(unsigned int value, int digits);
@@ -22,3 +46,7 @@ std::vector<std::wstring> splitString(const std::wstring& str, const wchar_t del
 std::wstring toWLowercase(const std::string& str);
 size_t replaceAll(std::wstring& str, const wchar_t* oldValue,const std::wstring& newValue);
 bool startsWith(const std::wstring& str, const wchar_t* value, size_t stringPos = 0);
+
+// an unused name next to fileName that no other writer picks, also in other
+// processes. used for files that are renamed into place once complete
+fs::path getTemporaryFileName(const fs::path& fileName);